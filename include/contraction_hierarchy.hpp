@@ -0,0 +1,417 @@
+#ifndef CONTRACTION_HIERARCHY_HPP
+#define CONTRACTION_HIERARCHY_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "graph.hpp"
+#include "graph_file.hpp"
+#include "parallel.hpp"
+
+// Contraction hierarchy over the ids of a CsrGraph. Nodes are contracted (removed) one at a time, and a
+// shortcut u -> w through v is added wherever u -> v -> w was the only shortest path between the
+// neighbours, so distances among the remaining nodes never change. Every edge then leads either up the
+// order (kept at its tail) or down it (kept at its head). A query searches upward from both ends and meets at
+// the highest-ranked node on the shortest path, settling a few hundred nodes on road-like graphs.
+//
+// Preprocessing runs in rounds. Each round takes every remaining node whose priority beats all of its
+// neighbours. The priority is twice the edge difference (shortcuts added minus edges removed), plus the number
+// of neighbours already contracted, plus the node's level (one above its highest contracted neighbour). These nodes
+// form an independent set and are contracted in parallel. Witness searches avoid the whole set, so shortcuts
+// from one contraction never rely on a path through another.
+class ContractionHierarchy {
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 500; // past this a witness search gives up and keeps the shortcut
+    static constexpr size_t PRIORITY_SETTLE_LIMIT = 50; // cheaper searches when only counting shortcuts
+
+    struct Arc {
+        uint32_t node;
+        uint32_t middle; // node the shortcut bypasses, NO_NODE for an original edge
+        double weight;
+    };
+    struct Shortcut {
+        uint32_t from, to;
+        double weight;
+    };
+    struct Owned {
+        std::vector<uint32_t> rank;
+        std::vector<size_t> up_offsets, down_offsets;
+        std::vector<uint32_t> up_nodes, up_middles, down_nodes, down_middles;
+        std::vector<double> up_weights, down_weights;
+    };
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t offset_size;
+        uint32_t padding;
+        uint64_t nodes;
+        uint64_t up_arcs;
+        uint64_t down_arcs;
+    };
+    static constexpr char MAGIC[8] = {'C', 'H', 'I', 'E', 'R', 'A', 'R', 'C'};
+    static constexpr uint32_t VERSION = 1;
+
+    // up row of u: arcs u -> v to higher-ranked v. down row of v: arcs u -> v from higher-ranked u, by u.
+    // Rows are sorted by node id.
+    std::shared_ptr<const void> _storage;
+    std::span<const uint32_t> _rank;
+    std::span<const size_t> _up_offsets, _down_offsets;
+    std::span<const uint32_t> _up_nodes, _up_middles, _down_nodes, _down_middles;
+    std::span<const double> _up_weights, _down_weights;
+
+    ContractionHierarchy() = default;
+
+    static std::vector<uint64_t> layout(uint64_t nodes, uint64_t up_arcs, uint64_t down_arcs) {
+        using graph_file::align;
+        uint64_t sizes[] = {nodes * sizeof(uint32_t), (nodes + 1) * sizeof(size_t), up_arcs * sizeof(uint32_t),
+                            up_arcs * sizeof(uint32_t), up_arcs * sizeof(double), (nodes + 1) * sizeof(size_t),
+                            down_arcs * sizeof(uint32_t), down_arcs * sizeof(uint32_t), down_arcs * sizeof(double)};
+        std::vector<uint64_t> ret = {align(sizeof(Header))}; // start of each array, then the file size
+        for (uint64_t size : sizes) ret.push_back(align(ret.back() + size));
+        ret.back() = ret[ret.size() - 2] + sizes[std::size(sizes) - 1];
+        return ret;
+    }
+
+    void view(std::shared_ptr<const void> storage, std::span<const uint32_t> rank, std::span<const size_t> up_offsets,
+              std::span<const uint32_t> up_nodes, std::span<const uint32_t> up_middles, std::span<const double> up_weights,
+              std::span<const size_t> down_offsets, std::span<const uint32_t> down_nodes,
+              std::span<const uint32_t> down_middles, std::span<const double> down_weights) {
+        _storage = std::move(storage);
+        _rank = rank;
+        _up_offsets = up_offsets;
+        _up_nodes = up_nodes;
+        _up_middles = up_middles;
+        _up_weights = up_weights;
+        _down_offsets = down_offsets;
+        _down_nodes = down_nodes;
+        _down_middles = down_middles;
+        _down_weights = down_weights;
+    }
+
+    // Shortcuts needed to contract v: u -> w for each in-neighbour u and out-neighbour w, unless a path from u
+    // to w that avoids v and every blocked node is at most as long as u -> v -> w.
+    template <typename Blocked>
+    static void shortcuts(uint32_t v, const std::vector<std::vector<Arc>>& out, const std::vector<std::vector<Arc>>& in,
+                          Blocked&& blocked, size_t settle_limit, SearchScratch& s, std::vector<Shortcut>& ret) {
+        for (const Arc& first : in[v]) {
+            uint32_t u = first.node;
+            double limit = -1;
+            for (const Arc& second : out[v]) {
+                if (second.node != u) limit = std::max(limit, first.weight + second.weight);
+            }
+            if (limit < 0) continue; // u's only way on is back to itself
+            size_t pending = 0; // targets not yet settled
+            for (const Arc& second : out[v]) pending += second.node != u;
+            s.start(out.size());
+            s.set(u, 0, NO_NODE);
+            s.heap.push(u, 0);
+            for (size_t settled = 0; !s.heap.empty() && settled < settle_limit; ++settled) {
+                auto [x, d] = s.heap.pop();
+                if (d > limit) break;
+                bool target = x != u && std::any_of(out[v].begin(), out[v].end(), [&](const Arc& a) { return a.node == x; });
+                if (target && --pending == 0) break;
+                for (const Arc& arc : out[x]) {
+                    if (arc.node == v || blocked(arc.node)) continue;
+                    double nd = d + arc.weight;
+                    if (nd < s.dist(arc.node)) {
+                        s.set(arc.node, nd, x);
+                        s.heap.push(arc.node, nd);
+                    }
+                }
+            }
+            for (const Arc& second : out[v]) {
+                double through = first.weight + second.weight;
+                if (second.node != u && s.dist(second.node) > through) ret.push_back({u, second.node, through});
+            }
+        }
+    }
+
+    static void upsert(std::vector<Arc>& arcs, Arc arc) {
+        for (Arc& existing : arcs) {
+            if (existing.node != arc.node) continue;
+            if (arc.weight < existing.weight) existing = arc;
+            return;
+        }
+        arcs.push_back(arc);
+    }
+
+    static size_t find(std::span<const uint32_t> nodes, size_t first, size_t last, uint32_t node) {
+        return std::lower_bound(nodes.begin() + first, nodes.begin() + last, node) - nodes.begin();
+    }
+    uint32_t middle(uint32_t u, uint32_t v) const { // of the arc u -> v in the hierarchy
+        if (_rank[u] < _rank[v]) return _up_middles[find(_up_nodes, _up_offsets[u], _up_offsets[u + 1], v)];
+        return _down_middles[find(_down_nodes, _down_offsets[v], _down_offsets[v + 1], u)];
+    }
+
+    // Upward searches from both ends, with stall-on-demand: a node reached more cheaply through a
+    // higher-ranked node than by its own label cannot be on a shortest up-down path, so it is not expanded.
+    // Returns the distance and the meeting node.
+    std::pair<double, uint32_t> search(uint32_t source, uint32_t target, SearchScratch& forward, SearchScratch& backward) const {
+        if (source >= size()) throw NonexistentNode(source);
+        if (target >= size()) throw NonexistentNode(target);
+        forward.start(size());
+        backward.start(size());
+        forward.set(source, 0, NO_NODE);
+        forward.heap.push(source, 0);
+        backward.set(target, 0, NO_NODE);
+        backward.heap.push(target, 0);
+        double best = source == target ? 0 : std::numeric_limits<double>::infinity();
+        uint32_t meet = source == target ? source : NO_NODE;
+
+        auto step = [&](SearchScratch& side, const SearchScratch& other, std::span<const size_t> offsets, std::span<const uint32_t> nodes,
+                        std::span<const double> weights, std::span<const size_t> stall_offsets, std::span<const uint32_t> stall_nodes,
+                        std::span<const double> stall_weights) {
+            auto [u, d] = side.heap.pop();
+            for (size_t e = stall_offsets[u]; e < stall_offsets[u + 1]; ++e) {
+                if (side.dist(stall_nodes[e]) + stall_weights[e] < d) return;
+            }
+            for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t v = nodes[e];
+                double nd = d + weights[e];
+                if (nd >= side.dist(v)) continue;
+                side.set(v, nd, u);
+                side.heap.push(v, nd);
+                if (nd + other.dist(v) < best) {
+                    best = nd + other.dist(v);
+                    meet = v;
+                }
+            }
+        };
+        while (true) {
+            bool go_forward = !forward.heap.empty() && forward.heap.top().second < best;
+            bool go_backward = !backward.heap.empty() && backward.heap.top().second < best;
+            if (!go_forward && !go_backward) break;
+            if (go_forward && (!go_backward || forward.heap.top().second <= backward.heap.top().second)) {
+                step(forward, backward, _up_offsets, _up_nodes, _up_weights, _down_offsets, _down_nodes, _down_weights);
+            } else {
+                step(backward, forward, _down_offsets, _down_nodes, _down_weights, _up_offsets, _up_nodes, _up_weights);
+            }
+        }
+        return {best, meet};
+    }
+
+public:
+    template <typename T>
+    explicit ContractionHierarchy(const CsrGraph<T>& g, parallel::ThreadPool& pool = parallel::default_pool()) {
+        const size_t n = g.size();
+        std::vector<std::vector<Arc>> out(n), in(n), up(n), down(n);
+        for (uint32_t u = 0; u < n; ++u) {
+            auto targets = g.targets(u);
+            auto weights = g.weights(u);
+            for (size_t i = 0; i < targets.size(); ++i) {
+                if (weights[i] < 0) throw NegativeWeight();
+                if (targets[i] == u) continue;
+                upsert(out[u], {targets[i], NO_NODE, weights[i]});
+                upsert(in[targets[i]], {u, NO_NODE, weights[i]});
+            }
+        }
+
+        std::vector<SearchScratch> scratch(pool.size());
+        std::vector<std::vector<Shortcut>> found(pool.size());
+        std::vector<uint8_t> contracted(n, 0), in_round(n, 0);
+        std::vector<uint32_t> deleted(n, 0), level(n, 0);
+        std::vector<double> priority(n);
+        auto prioritize = [&](size_t t, uint32_t v) {
+            found[t].clear();
+            shortcuts(v, out, in, [&](uint32_t) { return false; }, PRIORITY_SETTLE_LIMIT, scratch[t], found[t]);
+            double edge_difference = double(found[t].size()) - double(in[v].size() + out[v].size());
+            priority[v] = 2 * edge_difference + deleted[v] + level[v];
+        };
+        parallel::for_chunks(0, n, [&](size_t t, size_t first, size_t last) {
+            for (size_t v = first; v < last; ++v) prioritize(t, v);
+        }, pool, 256);
+
+        auto owned = std::make_shared<Owned>();
+        owned->rank.assign(n, NO_NODE);
+        std::vector<uint32_t> remaining(n), chosen, touched;
+        for (uint32_t v = 0; v < n; ++v) remaining[v] = v;
+        uint32_t next_rank = 0;
+        while (!remaining.empty()) {
+            auto beats = [&](uint32_t v, uint32_t x) { return std::make_pair(priority[v], v) < std::make_pair(priority[x], x); };
+            chosen.clear();
+            for (uint32_t v : remaining) {
+                bool local_minimum = std::all_of(in[v].begin(), in[v].end(), [&](const Arc& a) { return beats(v, a.node); })
+                    && std::all_of(out[v].begin(), out[v].end(), [&](const Arc& a) { return beats(v, a.node); });
+                if (local_minimum) chosen.push_back(v);
+            }
+            for (uint32_t v : chosen) in_round[v] = 1;
+
+            std::vector<std::vector<Shortcut>> added(chosen.size());
+            parallel::for_chunks(0, chosen.size(), [&](size_t t, size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    uint32_t v = chosen[i];
+                    shortcuts(v, out, in, [&](uint32_t x) { return in_round[x] != 0; }, WITNESS_SETTLE_LIMIT, scratch[t], added[i]);
+                    up[v] = out[v];
+                    down[v] = in[v];
+                }
+            }, pool, 16);
+
+            // Group the changes by the neighbour they touch, so each neighbour's lists are edited by one thread.
+            std::vector<std::pair<uint32_t, uint32_t>> edits; // neighbour, index into chosen
+            for (size_t i = 0; i < chosen.size(); ++i) {
+                uint32_t v = chosen[i];
+                owned->rank[v] = next_rank++;
+                contracted[v] = 1;
+                for (const Arc& a : in[v]) edits.push_back({a.node, i});
+                for (const Arc& a : out[v]) edits.push_back({a.node, i});
+                std::vector<Arc>().swap(in[v]);
+                std::vector<Arc>().swap(out[v]);
+            }
+            std::sort(edits.begin(), edits.end());
+            touched.clear();
+            for (size_t i = 0; i < edits.size(); ++i) {
+                if (i == 0 || edits[i].first != edits[i - 1].first) touched.push_back(i);
+            }
+            touched.push_back(edits.size());
+            parallel::for_each(0, touched.size() - 1, [&](size_t k) {
+                uint32_t x = edits[touched[k]].first;
+                std::erase_if(in[x], [&](const Arc& a) { return contracted[a.node] != 0; });
+                std::erase_if(out[x], [&](const Arc& a) { return contracted[a.node] != 0; });
+                for (size_t e = touched[k]; e < touched[k + 1]; ++e) {
+                    if (e > touched[k] && edits[e].second == edits[e - 1].second) continue; // in- and out-neighbour
+                    uint32_t v = chosen[edits[e].second];
+                    ++deleted[x];
+                    level[x] = std::max(level[x], level[v] + 1);
+                    for (const Shortcut& s : added[edits[e].second]) {
+                        if (s.from == x) upsert(out[x], {s.to, v, s.weight});
+                        if (s.to == x) upsert(in[x], {s.from, v, s.weight});
+                    }
+                }
+            }, pool, 16);
+            for (uint32_t v : chosen) in_round[v] = 0;
+            std::erase_if(remaining, [&](uint32_t v) { return contracted[v] != 0; });
+            parallel::for_chunks(0, touched.size() - 1, [&](size_t t, size_t first, size_t last) {
+                for (size_t k = first; k < last; ++k) prioritize(t, edits[touched[k]].first);
+            }, pool, 16);
+        }
+
+        auto flatten = [&](std::vector<std::vector<Arc>>& rows, std::vector<size_t>& offsets, std::vector<uint32_t>& nodes,
+                           std::vector<uint32_t>& middles, std::vector<double>& weights) {
+            offsets.assign(n + 1, 0);
+            for (size_t u = 0; u < n; ++u) offsets[u + 1] = offsets[u] + rows[u].size();
+            nodes.resize(offsets[n]);
+            middles.resize(offsets[n]);
+            weights.resize(offsets[n]);
+            parallel::for_each(0, n, [&](size_t u) {
+                std::sort(rows[u].begin(), rows[u].end(), [](const Arc& a, const Arc& b) { return a.node < b.node; });
+                for (size_t i = 0; i < rows[u].size(); ++i) {
+                    nodes[offsets[u] + i] = rows[u][i].node;
+                    middles[offsets[u] + i] = rows[u][i].middle;
+                    weights[offsets[u] + i] = rows[u][i].weight;
+                }
+                std::vector<Arc>().swap(rows[u]);
+            }, pool, 256);
+        };
+        flatten(up, owned->up_offsets, owned->up_nodes, owned->up_middles, owned->up_weights);
+        flatten(down, owned->down_offsets, owned->down_nodes, owned->down_middles, owned->down_weights);
+        view(owned, owned->rank, owned->up_offsets, owned->up_nodes, owned->up_middles, owned->up_weights,
+             owned->down_offsets, owned->down_nodes, owned->down_middles, owned->down_weights);
+    }
+
+    size_t size() const { return _rank.size(); }
+    size_t arc_count() const { return _up_nodes.size() + _down_nodes.size(); }
+    size_t shortcut_count() const {
+        return std::count_if(_up_middles.begin(), _up_middles.end(), [](uint32_t m) { return m != NO_NODE; })
+            + std::count_if(_down_middles.begin(), _down_middles.end(), [](uint32_t m) { return m != NO_NODE; });
+    }
+    uint32_t rank(uint32_t id) const { return _rank[id]; } // contraction order, 0 first
+
+    // Queries reuse the calling thread's point-to-point scratch, like bidirectional_dijkstra().
+    double distance(uint32_t source, uint32_t target) const {
+        return search(source, target, point_to_point_detail::scratch(0), point_to_point_detail::scratch(1)).first;
+    }
+
+    Route route(uint32_t source, uint32_t target) const { // the path is unpacked down to original edges
+        SearchScratch& forward = point_to_point_detail::scratch(0);
+        SearchScratch& backward = point_to_point_detail::scratch(1);
+        auto [dist, meet] = search(source, target, forward, backward);
+        Route ret;
+        ret.dist = dist;
+        if (meet == NO_NODE) return ret;
+        std::vector<uint32_t> hops; // hierarchy path: source up to meet, then down to target
+        point_to_point_detail::walk(forward, meet, hops);
+        std::reverse(hops.begin(), hops.end());
+        point_to_point_detail::walk(backward, backward.pred(meet), hops);
+        ret.path.push_back(source);
+        std::vector<std::pair<uint32_t, uint32_t>> stack;
+        for (size_t i = 0; i + 1 < hops.size(); ++i) {
+            stack.push_back({hops[i], hops[i + 1]});
+            while (!stack.empty()) {
+                auto [u, v] = stack.back();
+                stack.pop_back();
+                uint32_t m = middle(u, v);
+                if (m == NO_NODE) {
+                    ret.path.push_back(v);
+                    continue;
+                }
+                stack.push_back({m, v});
+                stack.push_back({u, m});
+            }
+        }
+        return ret;
+    }
+
+    // Same layout rules as write_csr(): native byte order, every array 64-byte aligned.
+    void save(const std::string& path) const {
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byte_order = graph_file::ENDIAN_MARK;
+        header.offset_size = sizeof(size_t);
+        header.nodes = size();
+        header.up_arcs = _up_nodes.size();
+        header.down_arcs = _down_nodes.size();
+        std::vector<uint64_t> at = layout(header.nodes, header.up_arcs, header.down_arcs);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::system_error(errno, std::generic_category(), "create " + path);
+        size_t next = 0;
+        auto put = [&](const auto& array) {
+            static const char zeros[graph_file::ALIGNMENT] = {};
+            out.write(zeros, at[next++] - out.tellp());
+            out.write(reinterpret_cast<const char*>(array.data()), array.size_bytes());
+        };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        put(_rank);
+        put(_up_offsets);
+        put(_up_nodes);
+        put(_up_middles);
+        put(_up_weights);
+        put(_down_offsets);
+        put(_down_nodes);
+        put(_down_middles);
+        put(_down_weights);
+        if (!out.flush()) throw std::system_error(errno, std::generic_category(), "write " + path);
+    }
+
+    // Maps a file written by save() without reading it; throws BadGraphFile if it is not one.
+    static ContractionHierarchy open(const std::string& path) {
+        using graph_file::view;
+        auto file = std::make_shared<const graph_file::MappedFile>(path);
+        Header header;
+        if (file->size() < sizeof(Header)) throw BadGraphFile(path, "too short");
+        std::memcpy(&header, file->data(), sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) throw BadGraphFile(path, "bad magic number");
+        if (header.version != VERSION) throw BadGraphFile(path, "unsupported version " + std::to_string(header.version));
+        if (header.byte_order != graph_file::ENDIAN_MARK) throw BadGraphFile(path, "written with another byte order");
+        if (header.offset_size != sizeof(size_t)) throw BadGraphFile(path, "offset width does not match");
+        std::vector<uint64_t> at = layout(header.nodes, header.up_arcs, header.down_arcs);
+        if (at.back() != file->size()) throw BadGraphFile(path, "truncated or inconsistent sizes");
+        const uint64_t n = header.nodes, up = header.up_arcs, down = header.down_arcs;
+        ContractionHierarchy ret;
+        ret.view(file, view<uint32_t>(*file, at[0], n), view<size_t>(*file, at[1], n + 1), view<uint32_t>(*file, at[2], up),
+                 view<uint32_t>(*file, at[3], up), view<double>(*file, at[4], up), view<size_t>(*file, at[5], n + 1),
+                 view<uint32_t>(*file, at[6], down), view<uint32_t>(*file, at[7], down), view<double>(*file, at[8], down));
+        return ret;
+    }
+};
+
+#endif // CONTRACTION_HIERARCHY_HPP
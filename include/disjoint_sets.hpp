@@ -0,0 +1,57 @@
+#ifndef DISJOINT_SETS_HPP
+#define DISJOINT_SETS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+// Union-find over ids [0, n) that is safe to share between threads: find() does path halving with CAS, and
+// unite() links the root with the larger id under the smaller one, retrying if another thread got there first.
+class DisjointSets {
+    std::vector<uint32_t> _parent;
+
+    uint32_t parent(uint32_t x) { return std::atomic_ref<uint32_t>(_parent[x]).load(std::memory_order_relaxed); }
+
+public:
+    explicit DisjointSets(size_t n = 0) : _parent(n) {
+        for (size_t i = 0; i < n; ++i) _parent[i] = i;
+    }
+
+    size_t size() const { return _parent.size(); }
+
+    uint32_t find(uint32_t x) {
+        while (true) {
+            uint32_t p = parent(x);
+            if (p == x) return x;
+            uint32_t grandparent = parent(p);
+            if (p != grandparent) {
+                std::atomic_ref<uint32_t>(_parent[x]).compare_exchange_weak(p, grandparent, std::memory_order_relaxed);
+            }
+            x = grandparent;
+        }
+    }
+
+    bool same(uint32_t a, uint32_t b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return true;
+            if (parent(a) == a) return false; // a is still a root, so the two really are apart
+        }
+    }
+
+    bool unite(uint32_t a, uint32_t b) { // false if they were already in the same set
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return false;
+            if (a < b) std::swap(a, b);
+            uint32_t expected = a;
+            if (std::atomic_ref<uint32_t>(_parent[a]).compare_exchange_strong(expected, b, std::memory_order_acq_rel)) return true;
+        }
+    }
+};
+
+#endif // DISJOINT_SETS_HPP
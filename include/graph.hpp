@@ -3,15 +3,33 @@
 
 #include <exception>
 #include <unordered_map>
+#include <map>
+#include <cmath>
 #include <cstdlib>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <queue>
+#include <deque>
+#include <numeric>
+#include <memory>
+#include <mutex>
 #include <limits.h>
 #include <stack>
 #include <algorithm>
 #include <climits>
+#include <random>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <stdexcept>
+
+#include "disjoint_sets.hpp"
+#include "heap.hpp"
+#include "parallel.hpp"
 
 class NonexistentNode : public std::range_error {
 public:
@@ -23,451 +41,2069 @@ public:
     NonexistentEdge(const auto begin, const auto end) : std::range_error((std::ostringstream() << "The edge from " << begin << " to " << end << " does not exist.").str()) {}
 };
 
+constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+// Interns node keys into dense uint32_t ids, so graphs hash a key once at the boundary and use ids everywhere
+// else. Erased ids go on a free list and are handed out again by later insertions, so a graph that has lost
+// nodes has holes below bound(); compacted() renumbers them away.
 template <typename T>
-class Graph {
-protected:
-    std::unordered_map<T, std::unordered_map<T, double>*>* _adjacency; // begin, {{end, weight}}
+class NodeIndex {
+    std::vector<T> _keys; // id -> key; stale for erased ids
+    std::vector<bool> _live;
+    std::unordered_map<T, uint32_t> _ids;
+    std::vector<uint32_t> _free;
 
 public:
-    Graph() {
-        _adjacency = new std::unordered_map<T, std::unordered_map<T, double>*>;
+    NodeIndex() = default;
+
+    explicit NodeIndex(std::vector<T> keys) : _keys(std::move(keys)), _live(_keys.size(), true) { // ids in order
+        if (_keys.size() >= NO_NODE) throw std::length_error("NodeIndex supports at most 2^32 - 1 nodes");
+        _ids.reserve(_keys.size());
+        for (uint32_t i = 0; i < _keys.size(); ++i) {
+            if (!_ids.emplace(_keys[i], i).second) throw std::invalid_argument("NodeIndex keys must be unique");
+        }
+    }
+
+    size_t size() const { return _ids.size(); }
+    size_t bound() const { return _keys.size(); } // every live id is below this
+    bool dense() const { return _free.empty(); }
+    bool contains(const T& key) const { return _ids.contains(key); }
+    bool live(uint32_t id) const { return id < _live.size() && _live[id]; }
+
+    uint32_t find(const T& key) const { // NO_NODE if absent
+        auto it = _ids.find(key);
+        return it == _ids.end() ? NO_NODE : it->second;
+    }
+    uint32_t id(const T& key) const {
+        auto it = _ids.find(key);
+        if (it == _ids.end()) throw NonexistentNode(key);
+        return it->second;
     }
+    const T& key(uint32_t id) const { return _keys[id]; }
+    const std::vector<T>& keys() const { return _keys; }
 
-    ~Graph() {
-        for (auto& pair : *_adjacency) {
-            delete pair.second;
+    void reserve(size_t n) {
+        _keys.reserve(n);
+        _live.reserve(n);
+        _ids.reserve(n);
+    }
+
+    std::pair<uint32_t, bool> insert(const T& key) { // id, and whether the key is new
+        auto [it, added] = _ids.try_emplace(key, NO_NODE);
+        if (!added) return {it->second, false};
+        if (!_free.empty()) {
+            it->second = _free.back();
+            _free.pop_back();
+            _keys[it->second] = key;
+            _live[it->second] = true;
+        } else {
+            if (_keys.size() + 1 >= NO_NODE) {
+                _ids.erase(it);
+                throw std::length_error("NodeIndex supports at most 2^32 - 1 nodes");
+            }
+            it->second = _keys.size();
+            _keys.push_back(key);
+            _live.push_back(true);
         }
-        delete _adjacency;
+        return {it->second, true};
     }
 
-    size_t size() { return _adjacency->size(); }
+    uint32_t erase(const T& key) { // returns the freed id
+        uint32_t ret = id(key);
+        _ids.erase(key);
+        _live[ret] = false;
+        _free.push_back(ret);
+        return ret;
+    }
 
-    std::vector<T> nodes() { // not recommended to use
+    // Dense copy with live ids renumbered in order; remap[old id] is the new id, or NO_NODE for erased ids.
+    NodeIndex<T> compacted(std::vector<uint32_t>& remap) const {
+        remap.assign(_keys.size(), NO_NODE);
+        if (dense()) {
+            for (uint32_t i = 0; i < _keys.size(); ++i) remap[i] = i;
+            return *this;
+        }
+        std::vector<T> keys;
+        keys.reserve(size());
+        for (uint32_t i = 0; i < _keys.size(); ++i) {
+            if (!_live[i]) continue;
+            remap[i] = keys.size();
+            keys.push_back(_keys[i]);
+        }
+        return NodeIndex<T>(std::move(keys));
+    }
+};
+
+template <typename T>
+class CsrGraph;
+
+// Mutable graph for ingestion. Keys are interned once by a NodeIndex, and each node keeps its out-edges as
+// flat parallel id/weight vectors (12 bytes per edge), unsorted, so updates scan the node's out-edges. Each
+// node also keeps the ids of its in-neighbours (4 bytes per edge), so deleting a node only touches its own edges.
+template <typename T>
+class Graph {
+protected:
+    static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+
+    NodeIndex<T> _index;
+    std::vector<std::vector<uint32_t>> _targets; // id -> end ids
+    std::vector<std::vector<double>> _weights; // id -> weights, parallel to _targets
+    std::vector<std::vector<uint32_t>> _sources; // id -> begin ids of its in-edges, unsorted
+    size_t _edge_count = 0;
+
+    size_t slot(uint32_t begin, uint32_t end) const { // position of end among begin's out-edges, or NO_SLOT
+        const auto& targets = _targets[begin];
+        auto it = std::find(targets.begin(), targets.end(), end);
+        return it == targets.end() ? NO_SLOT : it - targets.begin();
+    }
+    void drop_slot(uint32_t begin, size_t i) { // leaves the reverse entry to the caller
+        _targets[begin][i] = _targets[begin].back();
+        _targets[begin].pop_back();
+        _weights[begin][i] = _weights[begin].back();
+        _weights[begin].pop_back();
+        --_edge_count;
+    }
+    void unlink_source(uint32_t end, uint32_t begin) {
+        auto& sources = _sources[end];
+        *std::find(sources.begin(), sources.end(), begin) = sources.back();
+        sources.pop_back();
+    }
+    void remove_slot(uint32_t begin, size_t i) {
+        unlink_source(_targets[begin][i], begin);
+        drop_slot(begin, i);
+    }
+
+public:
+    size_t size() const { return _index.size(); }
+    size_t edge_count() const { return _edge_count; }
+    bool contains(const T& node) const { return _index.contains(node); }
+    const NodeIndex<T>& index() const { return _index; }
+
+    // id-level access; ids are those of index() and only live ones are meaningful
+    std::span<const uint32_t> targets(uint32_t id) const { return _targets[id]; }
+    std::span<const double> weights(uint32_t id) const { return _weights[id]; }
+    std::span<const uint32_t> sources(uint32_t id) const { return _sources[id]; }
+
+    std::vector<T> nodes() const { // not recommended to use
         std::vector<T> ret;
-        for (const auto& key_value : *_adjacency) {
-            ret.push_back(key_value.first);
+        ret.reserve(size());
+        for (uint32_t u = 0; u < _index.bound(); ++u) {
+            if (_index.live(u)) ret.push_back(_index.key(u));
         }
         return ret;
     }
 
-    std::vector<std::tuple<T, T, double>> edges() { // not recommended to use
+    std::vector<std::tuple<T, T, double>> edges() const { // not recommended to use
         std::vector<std::tuple<T, T, double>> ret;
-        for (const auto& begin_ends : *_adjacency) {
-            for (const auto& end_weight : *(begin_ends.second)) {
-                ret.push_back({begin_ends.first, end_weight.first, end_weight.second});
+        ret.reserve(_edge_count);
+        for (uint32_t u = 0; u < _index.bound(); ++u) {
+            if (!_index.live(u)) continue;
+            for (size_t i = 0; i < _targets[u].size(); ++i) {
+                ret.push_back({_index.key(u), _index.key(_targets[u][i]), _weights[u][i]});
             }
         }
         return ret;
     }
 
     void clear_node(T node) {
-        if (_adjacency->contains(node)) delete (*_adjacency)[node];
-        (*_adjacency)[node] = new std::unordered_map<T, double>;
+        auto [id, added] = _index.insert(node);
+        if (id >= _targets.size()) {
+            _targets.resize(id + 1);
+            _weights.resize(id + 1);
+            _sources.resize(id + 1);
+        }
+        for (uint32_t v : _targets[id]) unlink_source(v, id);
+        _edge_count -= _targets[id].size();
+        _targets[id].clear();
+        _weights[id].clear();
     }
 
     void update_edge(T begin, T end, double weight) {
-        if (!_adjacency->contains(begin)) throw NonexistentNode(begin);
-        if (!_adjacency->contains(end)) throw NonexistentNode(end);
-        (*(*_adjacency)[begin])[end] = weight;
+        uint32_t b = _index.id(begin), e = _index.id(end);
+        size_t i = slot(b, e);
+        if (i != NO_SLOT) {
+            _weights[b][i] = weight;
+            return;
+        }
+        _targets[b].push_back(e);
+        _weights[b].push_back(weight);
+        _sources[e].push_back(b);
+        ++_edge_count;
     }
 
-    void del_node(T node) {
-        if (!_adjacency->contains(node)) throw NonexistentNode(node);
-        _adjacency->erase(node);
-        for (auto& i : *_adjacency) {
-            (*_adjacency)[i.first].erase(node);
+    // Same result as calling update_edge on each edge in order, so the last weight of a repeated edge wins.
+    // Endpoints are resolved up front and a missing one throws NonexistentNode before anything changes. Edges
+    // are then bucketed by source, and each source's out-edges (and each target's in-edges) are grown once.
+    void bulk_load(std::span<const std::tuple<T, T, double>> edges, parallel::ThreadPool& pool = parallel::default_pool()) {
+        struct Entry {
+            uint32_t begin, end;
+            double weight;
+        };
+        const size_t n = _index.bound(), m = edges.size();
+        std::vector<Entry> resolved(m);
+        parallel::for_each(0, m, [&](size_t i) {
+            const auto& [begin, end, weight] = edges[i];
+            resolved[i] = {_index.id(begin), _index.id(end), weight};
+        }, pool, 4096);
+
+        std::vector<size_t> offsets(n + 1, 0); // stable counting sort by source keeps input order per bucket
+        for (const Entry& edge : resolved) ++offsets[edge.begin + 1];
+        for (size_t u = 0; u < n; ++u) offsets[u + 1] += offsets[u];
+        std::vector<Entry> sorted(m);
+        {
+            std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+            for (const Entry& edge : resolved) sorted[fill[edge.begin]++] = edge;
+        }
+        std::vector<Entry>().swap(resolved);
+
+        std::vector<uint8_t> fresh(m, 0); // entries that became new edges, rather than duplicates or reweights
+        std::atomic<size_t> added = 0;
+        parallel::for_chunks(0, n, [&](size_t, size_t first_node, size_t last_node) {
+            size_t count = 0;
+            std::vector<std::pair<uint32_t, uint32_t>> existing; // end, slot
+            for (size_t u = first_node; u < last_node; ++u) {
+                size_t first = offsets[u], last = offsets[u + 1];
+                if (first == last) continue;
+                std::stable_sort(sorted.begin() + first, sorted.begin() + last, [](const Entry& a, const Entry& b) { return a.end < b.end; });
+                auto& targets = _targets[u];
+                auto& weights = _weights[u];
+                existing.clear();
+                for (uint32_t i = 0; i < targets.size(); ++i) existing.push_back({targets[i], i});
+                std::sort(existing.begin(), existing.end());
+                targets.reserve(targets.size() + (last - first));
+                weights.reserve(weights.size() + (last - first));
+                for (size_t k = first; k < last; ++k) {
+                    const Entry& edge = sorted[k];
+                    if (k + 1 < last && sorted[k + 1].end == edge.end) continue; // a later duplicate wins
+                    auto it = std::lower_bound(existing.begin(), existing.end(), std::make_pair(edge.end, uint32_t(0)));
+                    if (it != existing.end() && it->first == edge.end) {
+                        weights[it->second] = edge.weight;
+                        continue;
+                    }
+                    targets.push_back(edge.end);
+                    weights.push_back(edge.weight);
+                    fresh[k] = 1;
+                    ++count;
+                }
+            }
+            added.fetch_add(count, std::memory_order_relaxed);
+        }, pool, 256);
+        _edge_count += added;
+
+        std::vector<size_t> in_offsets(n + 1, 0); // bucket the new edges by target for the reverse lists
+        for (size_t k = 0; k < m; ++k) {
+            if (fresh[k]) ++in_offsets[sorted[k].end + 1];
         }
+        for (size_t v = 0; v < n; ++v) in_offsets[v + 1] += in_offsets[v];
+        std::vector<uint32_t> in_sources(in_offsets.back());
+        {
+            std::vector<size_t> fill(in_offsets.begin(), in_offsets.end() - 1);
+            for (size_t k = 0; k < m; ++k) {
+                if (fresh[k]) in_sources[fill[sorted[k].end]++] = sorted[k].begin;
+            }
+        }
+        parallel::for_each(0, n, [&](size_t v) {
+            if (in_offsets[v] == in_offsets[v + 1]) return;
+            _sources[v].insert(_sources[v].end(), in_sources.begin() + in_offsets[v], in_sources.begin() + in_offsets[v + 1]);
+        }, pool, 256);
+    }
+
+    void del_node(T node) { // O(in-degree + out-degree + the out-degrees of its in-neighbours)
+        uint32_t id = _index.id(node);
+        for (uint32_t v : _targets[id]) {
+            if (v != id) unlink_source(v, id);
+        }
+        _edge_count -= _targets[id].size();
+        std::vector<uint32_t>().swap(_targets[id]);
+        std::vector<double>().swap(_weights[id]);
+        for (uint32_t u : _sources[id]) {
+            if (u != id) drop_slot(u, slot(u, id));
+        }
+        std::vector<uint32_t>().swap(_sources[id]);
+        _index.erase(node);
     }
 
     void del_edge(T begin, T end) {
-        if (!_adjacency->contains(begin)) throw NonexistentNode(begin);
-        if (!_adjacency->contains(end)) throw NonexistentNode(end);
-        if (!(*_adjacency)[begin]->contains(end)) throw NonexistentEdge(begin, end);
-        (*_adjacency)[begin]->erase(end);
+        uint32_t b = _index.id(begin), e = _index.id(end);
+        size_t i = slot(b, e);
+        if (i == NO_SLOT) throw NonexistentEdge(begin, end);
+        remove_slot(b, i);
+    }
+
+    double weight(T begin, T end) const {
+        uint32_t b = _index.id(begin), e = _index.id(end);
+        size_t i = slot(b, e);
+        if (i == NO_SLOT) throw NonexistentEdge(begin, end);
+        return _weights[b][i];
     }
 
-    double weight(T begin, T end) {
-        if (!_adjacency->contains(begin)) throw NonexistentNode(begin);
-        if (!_adjacency->contains(end)) throw NonexistentNode(end);
-        if (!(*_adjacency)[begin]->contains(end)) throw NonexistentEdge(begin, end);
-        return (*(*_adjacency)[begin])[end];
+    CsrGraph<T> freeze() const { // read-only snapshot; node ids follow nodes() order
+        std::vector<uint32_t> remap;
+        CsrGraph<T> csr(_index.compacted(remap));
+        std::vector<size_t> offsets = {0};
+        std::vector<uint32_t> targets;
+        std::vector<double> weights;
+        offsets.reserve(size() + 1);
+        targets.reserve(_edge_count);
+        weights.reserve(_edge_count);
+        for (uint32_t u = 0; u < _index.bound(); ++u) {
+            if (!_index.live(u)) continue;
+            for (uint32_t v : _targets[u]) targets.push_back(remap[v]);
+            weights.insert(weights.end(), _weights[u].begin(), _weights[u].end());
+            offsets.push_back(targets.size());
+        }
+        csr.assign_edges(std::move(offsets), std::move(targets), std::move(weights));
+        return csr;
     }
 };
 
-// Dijkstra
+// Compressed sparse row snapshot: node keys are interned into dense ids [0, size()), and the out-edges of
+// node u are targets[offsets[u] .. offsets[u + 1]) sorted by target id, with weights in the parallel array.
+// The arrays are read-only views of shared storage, either vectors the graph built itself or a file mapping
+// (see graph_file.hpp), so copies are cheap and share one buffer.
 
-class Graph {
-public:
-    int V;  // Number of vertices
-    std::vector<std::vector<std::pair<int, int>>> adj;  // Adjacency list where each pair is (neighbor, weight)
+template <typename T>
+class CsrGraph {
+    struct Lookup { // key -> id; built on first use for graphs viewing external keys
+        std::once_flag built;
+        NodeIndex<T> index;
+    };
+    struct Edges {
+        std::vector<size_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<double> weights;
+    };
+
+    std::shared_ptr<const void> _node_storage; // keeps _keys alive
+    std::shared_ptr<const void> _edge_storage; // keeps the edge arrays alive
+    std::shared_ptr<Lookup> _lookup;
+    std::span<const T> _keys; // id -> key
+    std::span<const size_t> _offsets; // id -> first edge, size() + 1 entries
+    std::span<const uint32_t> _targets; // edge -> end id
+    std::span<const double> _weights; // edge -> weight
+
+    static void sort_rows(const std::vector<size_t>& offsets, std::vector<uint32_t>& targets, std::vector<double>& weights) {
+        std::vector<std::pair<uint32_t, double>> row;
+        for (size_t u = 0; u + 1 < offsets.size(); ++u) {
+            size_t first = offsets[u], last = offsets[u + 1];
+            if (std::is_sorted(targets.begin() + first, targets.begin() + last)) continue;
+            row.clear();
+            for (size_t e = first; e < last; ++e) row.push_back({targets[e], weights[e]});
+            std::sort(row.begin(), row.end());
+            for (size_t e = first; e < last; ++e) {
+                targets[e] = row[e - first].first;
+                weights[e] = row[e - first].second;
+            }
+        }
+    }
+    void adopt_edges(std::vector<size_t> offsets, std::vector<uint32_t> targets, std::vector<double> weights) {
+        auto edges = std::make_shared<Edges>(std::move(offsets), std::move(targets), std::move(weights));
+        _offsets = edges->offsets;
+        _targets = edges->targets;
+        _weights = edges->weights;
+        _edge_storage = std::move(edges);
+    }
+    const NodeIndex<T>& lookup() const {
+        std::call_once(_lookup->built, [&] { _lookup->index = NodeIndex<T>(std::vector<T>(_keys.begin(), _keys.end())); });
+        return _lookup->index;
+    }
 
-    // Constructor to initialize graph with given number of vertices
-    Graph(int V) {
-        this->V = V;
-        adj.resize(V);
+public:
+    CsrGraph() : CsrGraph(NodeIndex<T>()) {}
+
+    explicit CsrGraph(NodeIndex<T> index) : _lookup(std::make_shared<Lookup>()) {
+        if (!index.dense()) throw std::invalid_argument("CsrGraph needs a dense NodeIndex");
+        std::call_once(_lookup->built, [&] { _lookup->index = std::move(index); });
+        _keys = _lookup->index.keys();
+        _node_storage = _lookup;
+        adopt_edges(std::vector<size_t>(size() + 1, 0), {}, {});
+    }
+    explicit CsrGraph(std::vector<T> keys) : CsrGraph(NodeIndex<T>(std::move(keys))) {}
+
+    // edges are (begin id, end id, weight); order does not matter
+    CsrGraph(std::vector<T> keys, const std::vector<std::tuple<uint32_t, uint32_t, double>>& edges) : CsrGraph(std::move(keys)) {
+        std::vector<size_t> offsets(size() + 1, 0);
+        for (const auto& [begin, end, weight] : edges) ++offsets[begin + 1];
+        for (size_t u = 0; u < size(); ++u) offsets[u + 1] += offsets[u];
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        std::vector<uint32_t> targets(edges.size());
+        std::vector<double> weights(edges.size());
+        for (const auto& [begin, end, weight] : edges) {
+            targets[fill[begin]] = end;
+            weights[fill[begin]++] = weight;
+        }
+        assign_edges(std::move(offsets), std::move(targets), std::move(weights));
     }
 
-    // Add an edge to the graph (u -> v with weight w)
-    void addEdge(int u, int v, int w) {
-        adj[u].push_back({v, w});
-        adj[v].push_back({u, w});  // Since it's an undirected graph
+    // Views arrays owned by storage without copying them. Keys must be unique and rows already sorted by
+    // target; only the array sizes are checked, so opening costs nothing per node or edge.
+    CsrGraph(std::shared_ptr<const void> storage, std::span<const T> keys, std::span<const size_t> offsets,
+             std::span<const uint32_t> targets, std::span<const double> weights)
+        : _node_storage(storage), _edge_storage(storage), _lookup(std::make_shared<Lookup>()), _keys(keys),
+          _offsets(offsets), _targets(targets), _weights(weights) {
+        if (offsets.size() != keys.size() + 1 || offsets.back() != targets.size() || targets.size() != weights.size()) {
+            throw std::invalid_argument("CsrGraph edge arrays do not match the node count");
+        }
     }
 
-    // Dijkstra's algorithm to find the shortest path from a source vertex
-    std::vector<int> dijkstra(int src) {
-        // Create a priority queue to store (distance, vertex)
-        std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
+    void assign_edges(std::vector<size_t> offsets, std::vector<uint32_t> targets, std::vector<double> weights) {
+        if (offsets.size() != size() + 1 || offsets.back() != targets.size() || targets.size() != weights.size()) {
+            throw std::invalid_argument("CsrGraph edge arrays do not match the node count");
+        }
+        sort_rows(offsets, targets, weights);
+        adopt_edges(std::move(offsets), std::move(targets), std::move(weights));
+    }
 
-        // Initialize distances with infinity
-        std::vector<int> dist(V, INT_MAX);
-        dist[src] = 0;
+    size_t size() const { return _keys.size(); }
+    size_t edge_count() const { return _targets.size(); }
+    bool contains(const T& node) const { return lookup().contains(node); }
+    const NodeIndex<T>& index() const { return lookup(); }
 
-        // Push the source vertex into the priority queue
-        pq.push({0, src});
+    uint32_t id(const T& node) const { return lookup().id(node); }
+    const T& key(uint32_t id) const { return _keys[id]; }
+    std::span<const T> keys() const { return _keys; }
 
-        // Process all vertices
-        while (!pq.empty()) {
-            int u = pq.top().second;
-            pq.pop();
+    size_t degree(uint32_t id) const { return _offsets[id + 1] - _offsets[id]; }
+    std::span<const uint32_t> targets(uint32_t id) const { return _targets.subspan(_offsets[id], degree(id)); }
+    std::span<const double> weights(uint32_t id) const { return _weights.subspan(_offsets[id], degree(id)); }
+    std::span<const size_t> offsets() const { return _offsets; }
+    std::span<const uint32_t> targets() const { return _targets; }
+    std::span<const double> weights() const { return _weights; }
 
-            // Explore the neighbors of u
-            for (auto& neighbor : adj[u]) {
-                int v = neighbor.first;
-                int weight = neighbor.second;
+    std::vector<T> nodes() const { return std::vector<T>(_keys.begin(), _keys.end()); }
 
-                // If a shorter path to v is found, update distance and push it to the queue
-                if (dist[u] + weight < dist[v]) {
-                    dist[v] = dist[u] + weight;
-                    pq.push({dist[v], v});
-                }
+    std::vector<std::tuple<T, T, double>> edges() const {
+        std::vector<std::tuple<T, T, double>> ret;
+        ret.reserve(_targets.size());
+        for (uint32_t u = 0; u < size(); ++u) {
+            for (size_t e = _offsets[u]; e < _offsets[u + 1]; ++e) {
+                ret.push_back({key(u), key(_targets[e]), _weights[e]});
             }
         }
+        return ret;
+    }
 
-        return dist;
+    // edge index of begin -> end, or edge_count() if there is none
+    size_t find_edge(uint32_t begin, uint32_t end) const {
+        auto row = targets(begin);
+        auto it = std::lower_bound(row.begin(), row.end(), end);
+        return (it != row.end() && *it == end) ? _offsets[begin] + (it - row.begin()) : _targets.size();
+    }
+
+    double weight(const T& begin, const T& end) const {
+        size_t e = find_edge(id(begin), id(end));
+        if (e == _targets.size()) throw NonexistentEdge(begin, end);
+        return _weights[e];
+    }
+
+    CsrGraph<T> transpose() const { // shares the node keys with this graph
+        std::vector<size_t> offsets(size() + 1, 0);
+        for (uint32_t v : _targets) ++offsets[v + 1];
+        for (size_t u = 0; u < size(); ++u) offsets[u + 1] += offsets[u];
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        std::vector<uint32_t> targets(_targets.size());
+        std::vector<double> weights(_targets.size());
+        for (uint32_t u = 0; u < size(); ++u) { // rows come out sorted since u increases
+            for (size_t e = _offsets[u]; e < _offsets[u + 1]; ++e) {
+                targets[fill[_targets[e]]] = u;
+                weights[fill[_targets[e]]++] = _weights[e];
+            }
+        }
+        CsrGraph<T> ret = *this;
+        ret.adopt_edges(std::move(offsets), std::move(targets), std::move(weights));
+        return ret;
     }
 };
 
-// Prim
+// Shortest paths
 
-class Graph {
+struct ShortestPaths {
+    std::vector<double> dist; // by node id; infinity if unreachable
+    std::vector<uint32_t> pred; // by node id; NO_NODE for the source and unreachable nodes
+    std::vector<uint32_t> negative_cycle; // set by Bellman-Ford if one is reachable, which makes dist meaningless
+
+    bool reached(uint32_t node) const { return dist[node] != std::numeric_limits<double>::infinity(); }
+
+    std::vector<uint32_t> path(uint32_t target) const { // node ids from the source to target, empty if unreachable
+        std::vector<uint32_t> ret;
+        if (!reached(target)) return ret;
+        for (uint32_t n = target; n != NO_NODE; n = pred[n]) ret.push_back(n);
+        std::reverse(ret.begin(), ret.end());
+        return ret;
+    }
+};
+
+class NegativeWeight : public std::invalid_argument {
 public:
-    int V;  // Number of vertices
-    std::vector<std::vector<std::pair<int, int>>> adj;  // Adjacency list where each pair is (neighbor, weight)
+    NegativeWeight() : std::invalid_argument("Edge weights must be non-negative for this algorithm.") {}
+};
 
-    // Constructor to initialize the graph with given number of vertices
-    Graph(int V) {
-        this->V = V;
-        adj.resize(V);
+// Heap is DaryHeap<D>, PairingHeap, or RadixHeap (integer weights only); see heap.hpp.
+template <typename Heap = DaryHeap<4>, typename T>
+ShortestPaths dijkstra(const CsrGraph<T>& g, uint32_t source) {
+    ShortestPaths sp{.dist = std::vector<double>(g.size(), std::numeric_limits<double>::infinity()),
+                     .pred = std::vector<uint32_t>(g.size(), NO_NODE),
+                     .negative_cycle = {}};
+    if (source >= g.size()) throw NonexistentNode(source);
+    Heap heap(g.size());
+    sp.dist[source] = 0;
+    heap.push(source, 0);
+    while (!heap.empty()) {
+        auto [u, d] = heap.pop();
+        if (d > sp.dist[u]) continue; // stale entry left behind by a lazy heap
+        auto targets = g.targets(u);
+        auto weights = g.weights(u);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (weights[i] < 0) throw NegativeWeight();
+            double nd = d + weights[i];
+            if (nd < sp.dist[targets[i]]) {
+                sp.dist[targets[i]] = nd;
+                sp.pred[targets[i]] = u;
+                heap.push(targets[i], nd);
+            }
+        }
+    }
+    return sp;
+}
+
+// Delta-stepping: nodes wait in buckets of width delta, and each bucket is settled by parallel rounds of
+// light-edge (weight <= delta) relaxation followed by one round over the heavy edges of every node it settled.
+// Node v is owned by thread v / block. Threads write relaxations into per-thread request buffers and each owner
+// applies the requests for its own nodes, so dist and pred are always updated together without atomics.
+// Each owner keeps only its non-empty buckets, in an ordered map, so a delta far below the edge weights costs
+// no memory or scanning for the empty buckets in between. delta <= 0 picks max weight / average degree.
+// Returns the same distances as dijkstra().
+template <typename T>
+ShortestPaths delta_stepping(const CsrGraph<T>& g, uint32_t source, double delta = 0, parallel::ThreadPool& pool = parallel::default_pool()) {
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    constexpr size_t GRAIN = 64;
+    struct Request {
+        uint32_t node;
+        uint32_t pred;
+        double dist;
+    };
+
+    const size_t n = g.size(), threads = pool.size();
+    ShortestPaths sp{.dist = std::vector<double>(n, INF), .pred = std::vector<uint32_t>(n, NO_NODE), .negative_cycle = {}};
+    if (source >= n) throw NonexistentNode(source);
+    const auto& all_weights = g.weights();
+    if (std::any_of(all_weights.begin(), all_weights.end(), [](double w) { return w < 0; })) throw NegativeWeight();
+    if (delta <= 0) {
+        double heaviest = all_weights.empty() ? 0 : *std::max_element(all_weights.begin(), all_weights.end());
+        delta = heaviest * n / std::max<size_t>(g.edge_count(), 1);
+        if (delta <= 0) delta = 1;
     }
 
-    // Add an edge to the graph (u <-> v with weight w)
-    void addEdge(int u, int v, int w) {
-        adj[u].push_back({v, w});
-        adj[v].push_back({u, w});  // Since it's an undirected graph
+    const size_t block = (n + threads - 1) / threads;
+    auto owner = [&](uint32_t v) { return v / block; };
+    auto bucket_of = [&](double d) { return std::floor(d / delta); }; // kept a double: d / delta may pass SIZE_MAX
+    std::vector<std::map<double, std::vector<uint32_t>>> buckets(threads); // [owner], non-empty buckets only
+    std::vector<std::vector<std::vector<Request>>> requests(threads, std::vector<std::vector<Request>>(threads)); // [writer][owner]
+    std::vector<std::vector<uint32_t>> frontier(threads), settled(threads); // [owner]
+    std::vector<double> relaxed(n, INF); // distance at which a node's light edges were last relaxed
+    std::vector<char> is_settled(n, 0);
+    double current = 0;
+
+    auto push = [&](size_t p, uint32_t v) { buckets[p][bucket_of(sp.dist[v])].push_back(v); };
+    auto apply = [&](size_t p) {
+        for (size_t t = 0; t < threads; ++t) {
+            for (const Request& r : requests[t][p]) {
+                if (r.dist < sp.dist[r.node]) {
+                    sp.dist[r.node] = r.dist;
+                    sp.pred[r.node] = r.pred;
+                    push(p, r.node);
+                }
+            }
+            requests[t][p].clear();
+        }
+    };
+    auto gather = [&](size_t p) {
+        frontier[p].clear();
+        auto bucket = buckets[p].find(current);
+        if (bucket == buckets[p].end()) return;
+        for (uint32_t v : bucket->second) {
+            if (bucket_of(sp.dist[v]) != current || relaxed[v] == sp.dist[v]) continue; // stale or duplicate entry
+            relaxed[v] = sp.dist[v];
+            frontier[p].push_back(v);
+            if (!is_settled[v]) {
+                is_settled[v] = 1;
+                settled[p].push_back(v);
+            }
+        }
+        buckets[p].erase(bucket);
+    };
+    auto relax = [&](const std::vector<std::vector<uint32_t>>& lists, bool light) {
+        std::vector<size_t> starts(threads + 1, 0);
+        for (size_t p = 0; p < threads; ++p) starts[p + 1] = starts[p] + lists[p].size();
+        std::atomic<size_t> next = 0;
+        pool.run([&](size_t t) {
+            for (size_t first; (first = next.fetch_add(GRAIN, std::memory_order_relaxed)) < starts.back();) {
+                size_t last = std::min(first + GRAIN, starts.back());
+                size_t p = std::upper_bound(starts.begin(), starts.end(), first) - starts.begin() - 1;
+                for (size_t i = first; i < last; ++i) {
+                    while (i >= starts[p + 1]) ++p;
+                    uint32_t u = lists[p][i - starts[p]];
+                    auto targets = g.targets(u);
+                    auto weights = g.weights(u);
+                    for (size_t e = 0; e < targets.size(); ++e) {
+                        if ((weights[e] <= delta) != light) continue;
+                        double nd = sp.dist[u] + weights[e];
+                        if (nd < sp.dist[targets[e]]) requests[t][owner(targets[e])].push_back({targets[e], u, nd});
+                    }
+                }
+            }
+        });
+    };
+    auto frontier_empty = [&] {
+        return std::all_of(frontier.begin(), frontier.end(), [](const auto& f) { return f.empty(); });
+    };
+
+    sp.dist[source] = 0;
+    push(owner(source), source);
+    while (true) {
+        bool any = false; // not INF as a sentinel: a bucket's index may itself overflow to INF
+        for (size_t p = 0; p < threads; ++p) {
+            if (buckets[p].empty()) continue;
+            if (!any || buckets[p].begin()->first < current) current = buckets[p].begin()->first;
+            any = true;
+        }
+        if (!any) break;
+
+        pool.run(gather);
+        while (!frontier_empty()) {
+            relax(frontier, true);
+            pool.run([&](size_t p) {
+                apply(p);
+                gather(p);
+            });
+        }
+        relax(settled, false);
+        pool.run([&](size_t p) {
+            apply(p);
+            for (uint32_t v : settled[p]) is_settled[v] = 0;
+            settled[p].clear();
+        });
     }
+    return sp;
+}
 
-    // Prim's algorithm to find the Minimum Spanning Tree (MST)
-    std::vector<std::pair<int, int>> primMST(int src) {
-        // Min-heap priority queue to store (weight, vertex)
-        std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
+// Point-to-point shortest paths
 
-        // To keep track of vertices included in MST
-        std::vector<bool> inMST(V, false);
+struct Route {
+    double dist = std::numeric_limits<double>::infinity();
+    std::vector<uint32_t> path; // node ids from the source to the target, empty if unreachable
 
-        // Vector to store the MST edges
-        std::vector<std::pair<int, int>> mstEdges;
+    bool reached() const { return !path.empty(); }
+};
 
-        // Start with the source vertex
-        pq.push({0, src});  // (weight, vertex)
-        
-        while (!pq.empty()) {
-            int u = pq.top().second;
-            int weight = pq.top().first;
-            pq.pop();
+// Search state reused across point-to-point queries. Entries are stamped with the generation that wrote
+// them, so starting a query bumps the generation instead of clearing O(V) arrays, and a query that settles
+// k nodes costs O(k log k) however large the graph is.
+class SearchScratch {
+    std::vector<double> _dist;
+    std::vector<uint32_t> _pred;
+    std::vector<uint32_t> _stamp;
+    uint32_t _generation = 0;
 
-            // If u is already in MST, skip it
-            if (inMST[u]) continue;
+public:
+    DaryHeap<4> heap;
+
+    void start(size_t n) {
+        if (_stamp.size() < n) {
+            _dist.resize(n);
+            _pred.resize(n);
+            _stamp.resize(n, 0);
+            heap = DaryHeap<4>(n);
+        }
+        heap.clear();
+        if (++_generation == 0) { // wrapped around, so old stamps could look current
+            std::fill(_stamp.begin(), _stamp.end(), 0);
+            _generation = 1;
+        }
+    }
 
-            // Include this vertex in MST
-            inMST[u] = true;
+    double dist(uint32_t node) const { return _stamp[node] == _generation ? _dist[node] : std::numeric_limits<double>::infinity(); }
+    uint32_t pred(uint32_t node) const { return _stamp[node] == _generation ? _pred[node] : NO_NODE; }
+    void set(uint32_t node, double dist, uint32_t pred) {
+        _stamp[node] = _generation;
+        _dist[node] = dist;
+        _pred[node] = pred;
+    }
+};
+
+namespace point_to_point_detail {
+
+inline SearchScratch& scratch(size_t side) { // one pair per thread, shared by every query that thread runs
+    thread_local SearchScratch sides[2];
+    return sides[side];
+}
+
+inline void walk(const SearchScratch& s, uint32_t from, std::vector<uint32_t>& out) { // from, pred(from), ...
+    for (uint32_t n = from; n != NO_NODE; n = s.pred(n)) out.push_back(n);
+}
 
-            // Add the edge to the MST (except for the first one)
-            if (weight != 0) {  // The first vertex has no incoming edge
-                mstEdges.push_back({u, weight});
+}
+
+// Searches forward from source on g and backward from target on reverse (which must be g.transpose(), built
+// once and kept), always expanding the side with the smaller frontier. best is the shortest source-target
+// path seen where the two searches touch; it is final once the two frontier minimums add up to at least it.
+template <typename T>
+Route bidirectional_dijkstra(const CsrGraph<T>& g, const CsrGraph<T>& reverse, uint32_t source, uint32_t target) {
+    if (source >= g.size()) throw NonexistentNode(source);
+    if (target >= g.size()) throw NonexistentNode(target);
+    SearchScratch& forward = point_to_point_detail::scratch(0);
+    SearchScratch& backward = point_to_point_detail::scratch(1);
+    forward.start(g.size());
+    backward.start(g.size());
+    forward.set(source, 0, NO_NODE);
+    forward.heap.push(source, 0);
+    backward.set(target, 0, NO_NODE);
+    backward.heap.push(target, 0);
+
+    Route route;
+    uint32_t meet = NO_NODE;
+    if (source == target) {
+        route.dist = 0;
+        meet = source;
+    }
+    while (!forward.heap.empty() && !backward.heap.empty()
+           && forward.heap.top().second + backward.heap.top().second < route.dist) {
+        bool ahead = forward.heap.size() <= backward.heap.size();
+        SearchScratch& side = ahead ? forward : backward;
+        const SearchScratch& other = ahead ? backward : forward;
+        const CsrGraph<T>& graph = ahead ? g : reverse;
+        auto [u, d] = side.heap.pop();
+        auto targets = graph.targets(u);
+        auto weights = graph.weights(u);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (weights[i] < 0) throw NegativeWeight();
+            uint32_t v = targets[i];
+            double nd = d + weights[i];
+            if (nd >= side.dist(v)) continue;
+            side.set(v, nd, u);
+            side.heap.push(v, nd);
+            if (nd + other.dist(v) < route.dist) {
+                route.dist = nd + other.dist(v);
+                meet = v;
             }
+        }
+    }
+    if (meet == NO_NODE) return route;
+    point_to_point_detail::walk(forward, meet, route.path);
+    std::reverse(route.path.begin(), route.path.end());
+    point_to_point_detail::walk(backward, backward.pred(meet), route.path);
+    return route;
+}
+
+// heuristic(id) estimates the distance from id to target and must never overestimate it. Nodes are reopened
+// when a shorter path to them turns up, so an admissible heuristic is enough for an exact answer; a
+// consistent one (h(u) <= w(u, v) + h(v)) also settles every node at most once. A zero heuristic is Dijkstra
+// stopped at the target.
+template <typename T, typename Heuristic>
+Route astar(const CsrGraph<T>& g, uint32_t source, uint32_t target, Heuristic&& heuristic) {
+    if (source >= g.size()) throw NonexistentNode(source);
+    if (target >= g.size()) throw NonexistentNode(target);
+    SearchScratch& s = point_to_point_detail::scratch(0);
+    s.start(g.size());
+    s.set(source, 0, NO_NODE);
+    s.heap.push(source, heuristic(source));
+    while (!s.heap.empty()) {
+        uint32_t u = s.heap.pop().first;
+        if (u == target) break;
+        double d = s.dist(u);
+        auto targets = g.targets(u);
+        auto weights = g.weights(u);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (weights[i] < 0) throw NegativeWeight();
+            uint32_t v = targets[i];
+            double nd = d + weights[i];
+            if (nd >= s.dist(v)) continue;
+            s.set(v, nd, u);
+            s.heap.push(v, nd + heuristic(v));
+        }
+    }
+    Route route;
+    route.dist = s.dist(target);
+    if (route.dist == std::numeric_limits<double>::infinity()) return route;
+    point_to_point_detail::walk(s, target, route.path);
+    std::reverse(route.path.begin(), route.path.end());
+    return route;
+}
+
+// Bellman-Ford
+
+namespace bellman_ford_detail {
+
+// A cycle in the predecessor graph, in edge order, or empty. Once one exists it is always a negative cycle.
+inline std::vector<uint32_t> pred_cycle(const std::vector<uint32_t>& pred) {
+    std::vector<uint32_t> walk_of(pred.size(), NO_NODE);
+    for (uint32_t start = 0; start < pred.size(); ++start) {
+        uint32_t u = start;
+        while (u != NO_NODE && walk_of[u] == NO_NODE) {
+            walk_of[u] = start;
+            u = pred[u];
+        }
+        if (u == NO_NODE || walk_of[u] != start) continue; // ran into the source or an earlier walk
+        std::vector<uint32_t> cycle = {u};
+        for (uint32_t v = pred[u]; v != u; v = pred[v]) cycle.push_back(v);
+        std::reverse(cycle.begin(), cycle.end());
+        return cycle;
+    }
+    return {};
+}
 
-            // Update the priority queue with the neighbors of u
-            for (auto& neighbor : adj[u]) {
-                int v = neighbor.first;
-                int edgeWeight = neighbor.second;
+}
 
-                // If v is not in MST and the edge weight is smaller, push to pq
-                if (!inMST[v]) {
-                    pq.push({edgeWeight, v});
+// Round-based Bellman-Ford. Each round every node pulls the best offer over its in-edges (a flat scan of the
+// transposed edge array), reading last round's distances, so nodes are independent and the round runs in
+// parallel. Stops as soon as a round changes nothing. If rounds keep changing after n of them, the predecessor
+// graph is checked for the negative cycle, which is then returned in negative_cycle.
+template <typename T>
+ShortestPaths bellman_ford(const CsrGraph<T>& g, uint32_t source, parallel::ThreadPool& pool = parallel::default_pool()) {
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    const size_t n = g.size();
+    if (source >= n) throw NonexistentNode(source);
+    CsrGraph<T> reverse = g.transpose();
+    ShortestPaths sp{.dist = std::vector<double>(n, INF), .pred = std::vector<uint32_t>(n, NO_NODE), .negative_cycle = {}};
+    sp.dist[source] = 0;
+    std::vector<double> next_dist = sp.dist;
+    std::vector<uint32_t> next_pred = sp.pred;
+    for (size_t round = 1;; ++round) {
+        std::atomic<bool> changed = false;
+        parallel::for_chunks(0, n, [&](size_t, size_t first, size_t last) {
+            bool local = false;
+            for (uint32_t v = first; v < last; ++v) {
+                double best = sp.dist[v];
+                uint32_t best_pred = sp.pred[v];
+                auto sources = reverse.targets(v);
+                auto weights = reverse.weights(v);
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    if (sp.dist[sources[i]] + weights[i] < best) {
+                        best = sp.dist[sources[i]] + weights[i];
+                        best_pred = sources[i];
+                    }
                 }
+                local |= best < sp.dist[v];
+                next_dist[v] = best;
+                next_pred[v] = best_pred;
             }
+            if (local) changed = true;
+        }, pool, 1024);
+        sp.dist.swap(next_dist);
+        sp.pred.swap(next_pred);
+        if (!changed) break;
+        if (round % n == 0) {
+            sp.negative_cycle = bellman_ford_detail::pred_cycle(sp.pred);
+            if (!sp.negative_cycle.empty()) break;
         }
-
-        return mstEdges;
     }
-};
+    return sp;
+}
 
-// Tarjan
+// Queue-based Bellman-Ford (SPFA) with the small-label-first heuristic: a node whose new distance beats the
+// head of the queue jumps to the front. A path of n edges in the predecessor graph means a negative cycle.
+template <typename T>
+ShortestPaths spfa(const CsrGraph<T>& g, uint32_t source) {
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    const size_t n = g.size();
+    if (source >= n) throw NonexistentNode(source);
+    ShortestPaths sp{.dist = std::vector<double>(n, INF), .pred = std::vector<uint32_t>(n, NO_NODE), .negative_cycle = {}};
+    std::vector<uint32_t> edges(n, 0); // edges on the path that set dist
+    std::vector<char> queued(n, 0);
+    std::deque<uint32_t> queue = {source};
+    sp.dist[source] = 0;
+    queued[source] = 1;
+    while (!queue.empty()) {
+        uint32_t u = queue.front();
+        queue.pop_front();
+        queued[u] = 0;
+        auto targets = g.targets(u);
+        auto weights = g.weights(u);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            uint32_t v = targets[i];
+            if (!(sp.dist[u] + weights[i] < sp.dist[v])) continue;
+            sp.dist[v] = sp.dist[u] + weights[i];
+            sp.pred[v] = u;
+            edges[v] = edges[u] + 1;
+            if (edges[v] >= n) {
+                sp.negative_cycle = bellman_ford_detail::pred_cycle(sp.pred);
+                if (!sp.negative_cycle.empty()) return sp;
+            }
+            if (queued[v]) continue;
+            queued[v] = 1;
+            if (!queue.empty() && sp.dist[v] < sp.dist[queue.front()]) queue.push_front(v);
+            else queue.push_back(v);
+        }
+    }
+    return sp;
+}
+
+// Dynamic shortest paths
+
+// Single-source shortest paths kept up to date while a Graph changes. Edits go through this class, which
+// forwards them to the graph and remembers the touched edges; repair() then fixes only the part of the
+// shortest-path tree they affect (Ramalingam-Reps, in batches):
+//   - a tree edge that got heavier or went away invalidates the subtree under it. Those nodes are reseeded
+//     from their in-neighbours outside the subtree, found through Graph::sources();
+//   - an edge that got lighter or appeared seeds its head if it now offers a shorter path;
+//   - a Dijkstra pass from the seeds settles the rest.
+// Work is proportional to the nodes whose distance changes and their edges. Edits made to the graph directly
+// are not seen. Distances are indexed by the graph's node ids, with infinity for unreachable nodes.
+template <typename T>
+class DynamicShortestPaths {
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+
+    Graph<T>& _graph;
+    uint32_t _source;
+    std::vector<double> _dist;
+    std::vector<uint32_t> _pred;
+    std::vector<std::pair<uint32_t, uint32_t>> _changed; // edges touched since the last repair
+    DaryHeap<4> _heap;
+    std::vector<uint8_t> _affected;
+    std::vector<uint8_t> _logged;
+    std::vector<std::pair<uint32_t, double>> _log; // node and its distance before this repair, once per node
+
+    double edge_weight(uint32_t begin, uint32_t end) const { // infinity if the edge is gone
+        auto targets = _graph.targets(begin);
+        auto it = std::find(targets.begin(), targets.end(), end);
+        return it == targets.end() ? INF : _graph.weights(begin)[it - targets.begin()];
+    }
+    void grow() {
+        _dist.resize(_graph.index().bound(), INF);
+        _pred.resize(_graph.index().bound(), NO_NODE);
+        _affected.resize(_graph.index().bound(), 0);
+        _logged.resize(_graph.index().bound(), 0);
+    }
+    void set(uint32_t node, double dist, uint32_t pred) {
+        if (!_logged[node]) {
+            _logged[node] = 1;
+            _log.push_back({node, _dist[node]});
+        }
+        _dist[node] = dist;
+        _pred[node] = pred;
+    }
+    void relax(uint32_t begin, uint32_t end, double weight) {
+        if (_dist[begin] + weight >= _dist[end]) return;
+        set(end, _dist[begin] + weight, begin);
+        _heap.push(end, _dist[end]);
+    }
 
-class TarjanSCC {
 public:
-    TarjanSCC(int n) : n(n), time(0) {
-        adj.resize(n);
-        disc.resize(n, -1);
-        low.resize(n, -1);
-        inStack.resize(n, false);
+    DynamicShortestPaths(Graph<T>& graph, const T& source) : _graph(graph), _source(graph.index().id(source)) {
+        for (uint32_t u = 0; u < _graph.index().bound(); ++u) {
+            if (!_graph.index().live(u)) continue;
+            for (double w : _graph.weights(u)) {
+                if (w < 0) throw NegativeWeight();
+            }
+        }
+        grow();
+        _dist[_source] = 0;
+        _heap.push(_source, 0);
+        repair();
+    }
+
+    const Graph<T>& graph() const { return _graph; }
+    uint32_t source() const { return _source; }
+    std::span<const double> distances() const { return _dist; } // by node id
+    std::span<const uint32_t> preds() const { return _pred; } // by node id; NO_NODE for the source and unreachable nodes
+    double distance(const T& node) const { return _dist[_graph.index().id(node)]; }
+    bool pending() const { return !_changed.empty(); }
+
+    void clear_node(const T& node) { // an existing node loses its out-edges
+        if (_graph.contains(node)) {
+            uint32_t id = _graph.index().id(node);
+            for (uint32_t v : _graph.targets(id)) _changed.push_back({id, v});
+        }
+        _graph.clear_node(node);
+        grow();
+        uint32_t id = _graph.index().id(node);
+        if (id != _source && _graph.targets(id).empty() && _graph.sources(id).empty()) { // new, maybe a reused id,
+            set(id, INF, NO_NODE); // or cut off by pending edits; logged so repair() counts and sees it
+        }
+    }
+
+    void update_edge(const T& begin, const T& end, double weight) {
+        if (weight < 0) throw NegativeWeight();
+        _graph.update_edge(begin, end, weight);
+        _changed.push_back({_graph.index().id(begin), _graph.index().id(end)});
+    }
+
+    void del_edge(const T& begin, const T& end) {
+        _graph.del_edge(begin, end);
+        _changed.push_back({_graph.index().id(begin), _graph.index().id(end)});
     }
 
-    // Add an edge to the graph
-    void addEdge(int u, int v) {
-        adj[u].push_back(v);
+    void del_node(const T& node) {
+        uint32_t id = _graph.index().id(node);
+        if (id == _source) throw std::invalid_argument("The source of DynamicShortestPaths cannot be deleted.");
+        for (uint32_t v : _graph.targets(id)) _changed.push_back({id, v});
+        _changed.push_back({_pred[id], id});
+        _graph.del_node(node);
     }
 
-    // Main function to find and print all SCCs
-    void findSCCs() {
-        for (int i = 0; i < n; ++i) {
-            if (disc[i] == -1) {
-                tarjanDFS(i);
+    // Applies every edit since the last call. Returns how many nodes changed distance.
+    size_t repair() {
+        grow();
+        std::vector<uint32_t> invalid; // subtree roots first, then their descendants
+        for (auto [u, v] : _changed) {
+            if (u == NO_NODE || _pred[v] != u || _affected[v]) continue;
+            if (_graph.index().live(v) && _graph.index().live(u) && _dist[u] + edge_weight(u, v) <= _dist[v]) continue;
+            _affected[v] = 1;
+            invalid.push_back(v);
+        }
+        for (size_t i = 0; i < invalid.size(); ++i) { // children are out-neighbours whose pred is the parent
+            uint32_t u = invalid[i];
+            if (!_graph.index().live(u)) continue;
+            for (uint32_t v : _graph.targets(u)) {
+                if (_pred[v] != u || _affected[v]) continue;
+                _affected[v] = 1;
+                invalid.push_back(v);
+            }
+        }
+        for (uint32_t v : invalid) set(v, INF, NO_NODE);
+        for (uint32_t v : invalid) {
+            if (!_graph.index().live(v)) continue;
+            for (uint32_t u : _graph.sources(v)) {
+                if (!_affected[u]) relax(u, v, edge_weight(u, v));
             }
         }
+        for (uint32_t v : invalid) _affected[v] = 0;
+        for (auto [u, v] : _changed) {
+            if (u != NO_NODE && _graph.index().live(u) && _graph.index().live(v)) relax(u, v, edge_weight(u, v));
+        }
+        _changed.clear();
+
+        while (!_heap.empty()) {
+            uint32_t u = _heap.pop().first;
+            auto targets = _graph.targets(u);
+            auto weights = _graph.weights(u);
+            for (size_t i = 0; i < targets.size(); ++i) relax(u, targets[i], weights[i]);
+        }
+        size_t changed = 0;
+        for (auto [node, before] : _log) {
+            changed += _dist[node] != before;
+            _logged[node] = 0;
+        }
+        _log.clear();
+        return changed;
     }
+};
 
-private:
-    int n; // Number of nodes
-    int time; // Timer to keep track of discovery time
-    std::vector<std::vector<int>> adj; // Adjacency list representation of the graph
-    std::vector<int> disc, low; // Discovery time and low-link values
-    std::vector<bool> inStack; // To check if a node is currently in the stack
-    std::stack<int> stk; // Stack to hold the nodes
+// Breadth-first search
 
-    // Helper function to perform DFS and find SCCs
-    void tarjanDFS(int u) {
-        // Set discovery time and low-link value
-        disc[u] = low[u] = time++;
-        stk.push(u);
-        inStack[u] = true;
+struct BfsTree {
+    std::vector<uint32_t> hops; // by node id; NO_NODE if unreachable
+    std::vector<uint32_t> parent; // by node id; NO_NODE for the source and unreachable nodes
 
-        // Explore the neighbors of u
-        for (int v : adj[u]) {
-            if (disc[v] == -1) {
-                tarjanDFS(v);
-                low[u] = std::min(low[u], low[v]);
-            } else if (inStack[v]) {
-                low[u] = std::min(low[u], disc[v]);
+    bool reached(uint32_t node) const { return hops[node] != NO_NODE; }
+
+    std::vector<uint32_t> path(uint32_t target) const { // node ids from the source to target, empty if unreachable
+        std::vector<uint32_t> ret;
+        if (!reached(target)) return ret;
+        for (uint32_t n = target; n != NO_NODE; n = parent[n]) ret.push_back(n);
+        std::reverse(ret.begin(), ret.end());
+        return ret;
+    }
+};
+
+// Direction-optimizing BFS (Beamer et al.). Small frontiers are expanded top-down from a node queue, claiming
+// children with a CAS on hops. Once the frontier's out-edges exceed 1/ALPHA of the unexplored edges it switches
+// to bottom-up steps: every unvisited node scans its in-edges (reverse must be g.transpose()) for a parent in
+// the frontier bitmap, with no atomics since each thread owns whole bitmap words. It switches back when the
+// frontier drops below n/BETA nodes. Stops after max_hops levels, which gives k-hop neighborhoods.
+template <typename T>
+BfsTree bfs(const CsrGraph<T>& g, const CsrGraph<T>& reverse, uint32_t source, uint32_t max_hops = NO_NODE,
+            parallel::ThreadPool& pool = parallel::default_pool()) {
+    constexpr size_t ALPHA = 14, BETA = 24, GRAIN = 64;
+    const size_t n = g.size(), words = (n + 63) / 64;
+    if (source >= n) throw NonexistentNode(source);
+    BfsTree tree{std::vector<uint32_t>(n, NO_NODE), std::vector<uint32_t>(n, NO_NODE)};
+    std::vector<uint32_t> queue = {source};
+    std::vector<std::vector<uint32_t>> found(pool.size()); // per-thread top-down output
+    std::vector<uint64_t> front, next; // bitmaps for bottom-up steps
+    bool bottom_up = false;
+    size_t frontier_size = 1, frontier_edges = g.degree(source), unexplored_edges = g.edge_count() - g.degree(source);
+    tree.hops[source] = 0;
+
+    for (uint32_t level = 0; frontier_size > 0 && level < max_hops; ++level) {
+        if (!bottom_up && frontier_edges > unexplored_edges / ALPHA) {
+            front.assign(words, 0);
+            for (uint32_t v : queue) front[v / 64] |= uint64_t(1) << (v % 64);
+            bottom_up = true;
+        } else if (bottom_up && frontier_size < n / BETA) {
+            queue.clear();
+            for (size_t w = 0; w < words; ++w) {
+                for (uint64_t bits = front[w]; bits; bits &= bits - 1) queue.push_back(w * 64 + std::countr_zero(bits));
             }
+            bottom_up = false;
         }
 
-        // If u is a root node, pop all nodes in the SCC
-        if (disc[u] == low[u]) {
-            std::cout << "SCC: ";
-            while (true) {
-                int w = stk.top();
-                stk.pop();
-                inStack[w] = false;
-                std::cout << w << " ";
-                if (w == u) break;
+        std::atomic<size_t> next_size = 0, next_edges = 0;
+        if (bottom_up) {
+            next.assign(words, 0);
+            parallel::for_chunks(0, words, [&](size_t, size_t first, size_t last) {
+                size_t size = 0, edges = 0;
+                for (size_t w = first; w < last; ++w) {
+                    uint64_t bits = 0;
+                    for (uint32_t v = w * 64; v < std::min(n, w * 64 + 64); ++v) {
+                        if (tree.hops[v] != NO_NODE) continue;
+                        for (uint32_t u : reverse.targets(v)) {
+                            if (!(front[u / 64] >> (u % 64) & 1)) continue;
+                            tree.hops[v] = level + 1;
+                            tree.parent[v] = u;
+                            bits |= uint64_t(1) << (v % 64);
+                            ++size;
+                            edges += g.degree(v);
+                            break;
+                        }
+                    }
+                    next[w] = bits;
+                }
+                next_size += size;
+                next_edges += edges;
+            }, pool, GRAIN);
+            front.swap(next);
+        } else {
+            parallel::for_chunks(0, queue.size(), [&](size_t t, size_t first, size_t last) {
+                size_t edges = 0;
+                for (size_t i = first; i < last; ++i) {
+                    for (uint32_t v : g.targets(queue[i])) {
+                        std::atomic_ref<uint32_t> hops(tree.hops[v]);
+                        uint32_t unvisited = NO_NODE;
+                        if (hops.load(std::memory_order_relaxed) != NO_NODE) continue;
+                        if (!hops.compare_exchange_strong(unvisited, level + 1, std::memory_order_relaxed)) continue;
+                        tree.parent[v] = queue[i];
+                        found[t].push_back(v);
+                        edges += g.degree(v);
+                    }
+                }
+                next_edges += edges;
+            }, pool, GRAIN);
+            queue.clear();
+            for (auto& f : found) {
+                queue.insert(queue.end(), f.begin(), f.end());
+                f.clear();
             }
-            std::cout << std::endl;
+            next_size = queue.size();
         }
+        frontier_size = next_size;
+        frontier_edges = next_edges;
+        unexplored_edges -= frontier_edges;
     }
+    return tree;
+}
+
+template <typename T>
+BfsTree bfs(const CsrGraph<T>& g, uint32_t source, uint32_t max_hops = NO_NODE, parallel::ThreadPool& pool = parallel::default_pool()) {
+    return bfs(g, g.transpose(), source, max_hops, pool);
+}
+
+// Strongly connected components
+
+struct Components {
+    std::vector<uint32_t> component; // by node id
+    size_t count = 0;
 };
 
-// Kahn
+// Iterative Tarjan. The DFS call stack and the component stack are members, so a long chain cannot overflow the
+// native stack and repeated runs on same-sized graphs do not allocate. Component ids come out in reverse
+// topological order of the condensation: edges only go from higher ids to lower or equal ones.
+class TarjanSCC {
+    std::vector<uint32_t> _index, _low, _stack;
+    std::vector<std::pair<uint32_t, size_t>> _call; // node, next edge
 
-class KahnTopologicalSort {
 public:
-    KahnTopologicalSort(int n) : n(n) {
-        adj.resize(n);
-        inDegree.resize(n, 0);
+    template <typename T>
+    Components run(const CsrGraph<T>& g) {
+        Components ret{std::vector<uint32_t>(g.size(), NO_NODE)};
+        finish(g, ret);
+        return ret;
     }
 
-    // Add an edge to the graph
-    void addEdge(int u, int v) {
-        adj[u].push_back(v);
-        inDegree[v]++; // Increment in-degree of vertex v
+    // Assigns ids from ret.count upwards to every node whose component is still NO_NODE, treating already
+    // assigned nodes as removed from the graph.
+    template <typename T>
+    void finish(const CsrGraph<T>& g, Components& ret) {
+        const auto& offsets = g.offsets();
+        const auto& targets = g.targets();
+        auto& comp = ret.component;
+        _index.assign(g.size(), NO_NODE);
+        _low.resize(g.size());
+        _stack.clear();
+        _call.clear();
+        _stack.reserve(g.size());
+        _call.reserve(g.size());
+        uint32_t counter = 0;
+        for (uint32_t root = 0; root < g.size(); ++root) {
+            if (comp[root] != NO_NODE || _index[root] != NO_NODE) continue;
+            _index[root] = _low[root] = counter++;
+            _stack.push_back(root);
+            _call.push_back({root, offsets[root]});
+            while (!_call.empty()) {
+                uint32_t u = _call.back().first;
+                size_t& e = _call.back().second;
+                if (e < offsets[u + 1]) {
+                    uint32_t v = targets[e++];
+                    if (comp[v] != NO_NODE) continue; // finished component, or excluded by the caller
+                    if (_index[v] == NO_NODE) {
+                        _index[v] = _low[v] = counter++;
+                        _stack.push_back(v);
+                        _call.push_back({v, offsets[v]});
+                    } else {
+                        _low[u] = std::min(_low[u], _index[v]); // visited and unassigned means on the stack
+                    }
+                    continue;
+                }
+                _call.pop_back();
+                if (!_call.empty()) _low[_call.back().first] = std::min(_low[_call.back().first], _low[u]);
+                if (_low[u] != _index[u]) continue;
+                uint32_t w;
+                do {
+                    w = _stack.back();
+                    _stack.pop_back();
+                    comp[w] = ret.count;
+                } while (w != u);
+                ++ret.count;
+            }
+        }
     }
+};
 
-    // Perform topological sort using Kahn's Algorithm
-    bool topologicalSort() {
-        std::queue<int> q;
-        std::vector<int> topOrder;
+template <typename T>
+Components strongly_connected_components(const CsrGraph<T>& g) {
+    return TarjanSCC().run(g);
+}
+
+// Parallel SCC for large graphs: a few rounds of trimming (nodes with no remaining in- or out-edges are
+// singleton components), forward-backward search from a high-degree pivot to peel off the giant component,
+// then coloring rounds (propagate the maximum id forward; each node that keeps its own color collects its
+// component by a backward search within that color). Coloring stops once a round makes little progress, and
+// Tarjan finishes the remainder. reverse must be g.transpose(). Component ids are in no particular order.
+template <typename T>
+Components parallel_scc(const CsrGraph<T>& g, const CsrGraph<T>& reverse, parallel::ThreadPool& pool = parallel::default_pool()) {
+    constexpr size_t TRIM_ROUNDS = 3, GRAIN = 256;
+    const size_t n = g.size();
+    Components ret{std::vector<uint32_t>(n, NO_NODE)};
+    auto& comp = ret.component;
+    std::atomic<uint32_t> next_id = 0;
+    auto assigned = [&](uint32_t v) { return std::atomic_ref<uint32_t>(comp[v]).load(std::memory_order_relaxed) != NO_NODE; };
+    auto assign = [&](uint32_t v, uint32_t id) { std::atomic_ref<uint32_t>(comp[v]).store(id, std::memory_order_relaxed); };
+    size_t remaining = n;
+
+    for (size_t round = 0; round < TRIM_ROUNDS; ++round) {
+        std::atomic<size_t> trimmed = 0;
+        parallel::for_chunks(0, n, [&](size_t, size_t first, size_t last) {
+            size_t count = 0;
+            for (uint32_t v = first; v < last; ++v) {
+                if (assigned(v)) continue;
+                auto live = [&](uint32_t u) { return u != v && !assigned(u); };
+                auto out = g.targets(v), in = reverse.targets(v);
+                if (std::none_of(out.begin(), out.end(), live) || std::none_of(in.begin(), in.end(), live)) {
+                    assign(v, next_id++);
+                    ++count;
+                }
+            }
+            trimmed += count;
+        }, pool, GRAIN);
+        remaining -= trimmed;
+        if (trimmed == 0) break;
+    }
 
-        // Enqueue nodes with in-degree 0 (no dependencies)
-        for (int i = 0; i < n; ++i) {
-            if (inDegree[i] == 0) {
-                q.push(i);
+    // forward-backward from the live node with the largest in * out degree
+    std::vector<std::vector<uint32_t>> found(pool.size());
+    auto reach = [&](const CsrGraph<T>& graph, uint32_t pivot, std::vector<char>& mark) {
+        std::vector<uint32_t> frontier = {pivot};
+        mark[pivot] = 1;
+        while (!frontier.empty()) {
+            parallel::for_chunks(0, frontier.size(), [&](size_t t, size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    for (uint32_t v : graph.targets(frontier[i])) {
+                        if (assigned(v) || std::atomic_ref<char>(mark[v]).exchange(1, std::memory_order_relaxed)) continue;
+                        found[t].push_back(v);
+                    }
+                }
+            }, pool, GRAIN);
+            frontier.clear();
+            for (auto& f : found) {
+                frontier.insert(frontier.end(), f.begin(), f.end());
+                f.clear();
             }
         }
+    };
+    if (remaining > 0) {
+        uint32_t pivot = NO_NODE;
+        size_t best = 0;
+        for (uint32_t v = 0; v < n; ++v) {
+            size_t score = (g.degree(v) + 1) * (reverse.degree(v) + 1);
+            if (!assigned(v) && (pivot == NO_NODE || score > best)) {
+                pivot = v;
+                best = score;
+            }
+        }
+        std::vector<char> forward(n, 0), backward(n, 0);
+        reach(g, pivot, forward);
+        reach(reverse, pivot, backward);
+        uint32_t id = next_id++;
+        for (uint32_t v = 0; v < n; ++v) {
+            if (forward[v] && backward[v]) {
+                comp[v] = id;
+                --remaining;
+            }
+        }
+    }
 
-        // Process the nodes in the queue
-        while (!q.empty()) {
-            int u = q.front();
-            q.pop();
-            topOrder.push_back(u);
-
-            // For each neighbor of u, reduce its in-degree
-            for (int v : adj[u]) {
-                inDegree[v]--;
-                if (inDegree[v] == 0) {
-                    q.push(v);
+    std::vector<uint32_t> color(n);
+    std::vector<std::vector<uint32_t>> regions(pool.size());
+    while (remaining > 0) {
+        parallel::for_each(0, n, [&](size_t v) { color[v] = v; }, pool);
+        for (std::atomic<bool> changed = true; changed;) {
+            changed = false;
+            parallel::for_chunks(0, n, [&](size_t, size_t first, size_t last) {
+                bool local = false;
+                for (uint32_t v = first; v < last; ++v) {
+                    if (assigned(v)) continue;
+                    uint32_t c = std::atomic_ref<uint32_t>(color[v]).load(std::memory_order_relaxed);
+                    for (uint32_t u : g.targets(v)) {
+                        if (assigned(u)) continue;
+                        std::atomic_ref<uint32_t> cu(color[u]);
+                        uint32_t old = cu.load(std::memory_order_relaxed);
+                        while (old < c && !cu.compare_exchange_weak(old, c, std::memory_order_relaxed)) {}
+                        if (old < c) local = true;
+                    }
                 }
-            }
+                if (local) changed = true;
+            }, pool, GRAIN);
         }
+        std::atomic<size_t> collected = 0;
+        parallel::for_chunks(0, n, [&](size_t t, size_t first, size_t last) {
+            auto& region = regions[t];
+            size_t count = 0;
+            for (uint32_t root = first; root < last; ++root) {
+                if (assigned(root) || color[root] != root) continue;
+                uint32_t id = next_id++;
+                region.assign(1, root); // only this thread touches nodes of color root
+                assign(root, id);
+                for (size_t i = 0; i < region.size(); ++i) {
+                    for (uint32_t u : reverse.targets(region[i])) {
+                        if (color[u] != root || assigned(u)) continue;
+                        assign(u, id);
+                        region.push_back(u);
+                    }
+                }
+                count += region.size();
+            }
+            collected += count;
+        }, pool, GRAIN);
+        remaining -= collected;
+        if (collected * 64 < remaining) break;
+    }
+    ret.count = next_id;
+    if (remaining > 0) TarjanSCC().finish(g, ret);
+    return ret;
+}
 
-        // Check if there was a cycle (i.e., not all nodes were processed)
-        if (topOrder.size() != n) {
-            std::cout << "The graph contains a cycle. Topological sort is not possible.\n";
-            return false;
+// Condensation DAG: node c is component c, with one edge per pair of connected components carrying the
+// smallest weight between them.
+template <typename T>
+CsrGraph<uint32_t> condense(const CsrGraph<T>& g, const Components& c) {
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges;
+    for (uint32_t u = 0; u < g.size(); ++u) {
+        auto targets = g.targets(u);
+        auto weights = g.weights(u);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (c.component[u] != c.component[targets[i]]) edges.push_back({c.component[u], c.component[targets[i]], weights[i]});
         }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end(), [](const auto& a, const auto& b) {
+        return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b);
+    }), edges.end());
+    std::vector<uint32_t> keys(c.count);
+    for (uint32_t i = 0; i < c.count; ++i) keys[i] = i;
+    return CsrGraph<uint32_t>(std::move(keys), edges);
+}
+
+// Topological sort
+
+struct TopologicalOrder {
+    std::vector<uint32_t> order; // node ids, level by level
+    std::vector<size_t> level_starts = {0}; // level i is order[level_starts[i] .. level_starts[i + 1])
+    std::vector<uint32_t> cycle; // empty for a DAG; otherwise each node has an edge to the next, and the last to the first
+
+    bool acyclic() const { return cycle.empty(); }
+    size_t levels() const { return level_starts.size() - 1; }
+    std::span<const uint32_t> level(size_t i) const {
+        return {order.data() + level_starts[i], order.data() + level_starts[i + 1]};
+    }
+};
 
-        // Print the topological order
-        std::cout << "Topological Sort: ";
-        for (int node : topOrder) {
-            std::cout << node << " ";
+// Parallel Kahn. Level 0 is every node without in-edges, and level i + 1 is every node whose last remaining
+// in-edge came from level i, so all nodes of a level can run at once. Each level is expanded in parallel with
+// atomic in-degree counters. on_level(std::span<const uint32_t>) is called on the calling thread as soon as a
+// level is known, before the next one is computed. Returns a witness cycle if some nodes were never released,
+// or an empty vector for a DAG.
+template <typename T, typename Fn>
+std::vector<uint32_t> topological_levels(const CsrGraph<T>& g, Fn&& on_level, parallel::ThreadPool& pool = parallel::default_pool()) {
+    constexpr size_t GRAIN = 256;
+    const size_t n = g.size();
+    std::vector<uint32_t> in_degree(n, 0);
+    parallel::for_each(0, g.edge_count(), [&](size_t e) {
+        std::atomic_ref<uint32_t>(in_degree[g.targets()[e]]).fetch_add(1, std::memory_order_relaxed);
+    }, pool, 4096);
+
+    std::vector<std::vector<uint32_t>> found(pool.size());
+    std::vector<uint32_t> level, next;
+    auto gather = [&] {
+        next.clear();
+        for (auto& f : found) {
+            next.insert(next.end(), f.begin(), f.end());
+            f.clear();
+        }
+    };
+    parallel::for_chunks(0, n, [&](size_t t, size_t first, size_t last) {
+        for (uint32_t v = first; v < last; ++v) {
+            if (in_degree[v] == 0) found[t].push_back(v);
+        }
+    }, pool, 4096);
+    gather();
+
+    size_t released = 0;
+    while (!next.empty()) {
+        level.swap(next);
+        released += level.size();
+        on_level(std::span<const uint32_t>(level));
+        parallel::for_chunks(0, level.size(), [&](size_t t, size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                for (uint32_t v : g.targets(level[i])) {
+                    if (std::atomic_ref<uint32_t>(in_degree[v]).fetch_sub(1, std::memory_order_acq_rel) == 1) found[t].push_back(v);
+                }
+            }
+        }, pool, GRAIN);
+        gather();
+    }
+    if (released == n) return {};
+
+    // Every node left over still has an in-edge from another leftover node, so walking those edges backwards
+    // must eventually revisit a node.
+    CsrGraph<T> reverse = g.transpose();
+    std::vector<uint32_t> walk, step(n, NO_NODE);
+    uint32_t u = std::find_if(in_degree.begin(), in_degree.end(), [](uint32_t d) { return d > 0; }) - in_degree.begin();
+    while (step[u] == NO_NODE) {
+        step[u] = walk.size();
+        walk.push_back(u);
+        for (uint32_t p : reverse.targets(u)) {
+            if (in_degree[p] > 0) {
+                u = p;
+                break;
+            }
         }
-        std::cout << std::endl;
-        return true;
     }
+    std::vector<uint32_t> cycle(walk.rbegin(), walk.rend() - step[u]);
+    return cycle;
+}
 
-private:
-    int n; // Number of nodes
-    std::vector<std::vector<int>> adj; // Adjacency list representation of the graph
-    std::vector<int> inDegree; // In-degree array
+template <typename T>
+TopologicalOrder topological_sort(const CsrGraph<T>& g, parallel::ThreadPool& pool = parallel::default_pool()) {
+    TopologicalOrder ret;
+    ret.order.reserve(g.size());
+    ret.cycle = topological_levels(g, [&](std::span<const uint32_t> level) {
+        ret.order.insert(ret.order.end(), level.begin(), level.end());
+        ret.level_starts.push_back(ret.order.size());
+    }, pool);
+    return ret;
+}
+
+// Minimum spanning forest. Both engines treat every edge as undirected and ignore self-loops.
+
+struct SpanningForest {
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges; // (u, v, weight) by node id
+    double weight = 0;
 };
 
-// Bellman-Ford
+namespace mst_detail {
 
 struct Edge {
-    int u, v, weight;
+    double weight;
+    uint32_t u, v;
 };
 
-// Bellman-Ford Algorithm to find the shortest paths from source
-class BellmanFord {
-public:
-    BellmanFord(int n) : n(n) {
-        dist.resize(n, INF); // Distance to all nodes is initially infinite
-        adj.resize(n); // Adjacency list to store the edges
+template <typename T>
+std::vector<Edge> undirected_edges(const CsrGraph<T>& g) {
+    std::vector<Edge> ret;
+    ret.reserve(g.edge_count());
+    for (uint32_t u = 0; u < g.size(); ++u) {
+        auto targets = g.targets(u);
+        auto weights = g.weights(u);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (targets[i] != u) ret.push_back({weights[i], u, targets[i]});
+        }
+    }
+    return ret;
+}
+
+// Stable parallel compaction: copies the edges of in satisfying keep into out and returns how many there were.
+template <typename Keep>
+size_t compact(const Edge* in, size_t n, Edge* out, Keep&& keep, parallel::ThreadPool& pool) {
+    const size_t chunks = std::min(pool.size() * 4, std::max<size_t>(n / 4096, 1));
+    std::vector<size_t> counts(chunks + 1, 0);
+    parallel::for_each(0, chunks, [&](size_t c) {
+        for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; ++i) counts[c + 1] += keep(in[i]);
+    }, pool, 1);
+    for (size_t c = 0; c < chunks; ++c) counts[c + 1] += counts[c];
+    parallel::for_each(0, chunks, [&](size_t c) {
+        Edge* to = out + counts[c];
+        for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; ++i) {
+            if (keep(in[i])) *to++ = in[i];
+        }
+    }, pool, 1);
+    return counts[chunks];
+}
+
+// Filter-Kruskal (Osipov, Sanders, Singler): partition around a sampled pivot weight, solve the light half,
+// then drop heavy edges whose endpoints the light half already connected before recursing on the rest.
+inline void filter_kruskal(Edge* edges, size_t n, Edge* scratch, DisjointSets& sets, SpanningForest& forest,
+                           std::mt19937& rng, parallel::ThreadPool& pool) {
+    constexpr size_t BASE = 1 << 14;
+    auto by_weight = [](const Edge& a, const Edge& b) { return a.weight < b.weight; };
+    double pivot = 0;
+    size_t light = n;
+    if (n > BASE) {
+        std::uniform_int_distribution<size_t> pick(0, n - 1);
+        double a = edges[pick(rng)].weight, b = edges[pick(rng)].weight, c = edges[pick(rng)].weight;
+        pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+        light = compact(edges, n, scratch, [&](const Edge& e) { return e.weight <= pivot; }, pool);
+        compact(edges, n, scratch + light, [&](const Edge& e) { return e.weight > pivot; }, pool);
+        std::copy(scratch, scratch + n, edges);
     }
+    if (light == n) { // small, or the pivot failed to split
+        std::sort(edges, edges + n, by_weight);
+        for (size_t i = 0; i < n; ++i) {
+            if (sets.unite(edges[i].u, edges[i].v)) {
+                forest.edges.push_back({edges[i].u, edges[i].v, edges[i].weight});
+                forest.weight += edges[i].weight;
+            }
+        }
+        return;
+    }
+    filter_kruskal(edges, light, scratch, sets, forest, rng, pool);
+    size_t heavy = compact(edges + light, n - light, scratch, [&](const Edge& e) { return !sets.same(e.u, e.v); }, pool);
+    std::copy(scratch, scratch + heavy, edges + light);
+    filter_kruskal(edges + light, heavy, scratch, sets, forest, rng, pool);
+}
+
+}
 
-    // Add an edge to the graph
-    void addEdge(int u, int v, int weight) {
-        adj[u].push_back({u, v, weight});
+template <typename T>
+SpanningForest filter_kruskal(const CsrGraph<T>& g, parallel::ThreadPool& pool = parallel::default_pool()) {
+    std::vector<mst_detail::Edge> edges = mst_detail::undirected_edges(g), scratch(edges.size());
+    DisjointSets sets(g.size());
+    SpanningForest forest;
+    std::mt19937 rng(edges.size());
+    mst_detail::filter_kruskal(edges.data(), edges.size(), scratch.data(), sets, forest, rng, pool);
+    return forest;
+}
+
+// Parallel Borůvka: every round, each component picks its lightest outgoing edge (ties broken by edge index,
+// so the picks never close a cycle), all picks are united at once, and edges inside one component are dropped.
+template <typename T>
+SpanningForest boruvka(const CsrGraph<T>& g, parallel::ThreadPool& pool = parallel::default_pool()) {
+    constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    std::vector<mst_detail::Edge> edges = mst_detail::undirected_edges(g), scratch(edges.size());
+    if (edges.size() >= NONE) throw std::length_error("boruvka supports at most 2^32 - 1 edges");
+    DisjointSets sets(g.size());
+    SpanningForest forest;
+    std::vector<uint32_t> best(g.size(), NONE), live(edges.size());
+    std::vector<std::vector<uint32_t>> picked(pool.size());
+    for (uint32_t i = 0; i < live.size(); ++i) live[i] = i;
+    auto lighter = [&](uint32_t a, uint32_t b) {
+        return edges[a].weight < edges[b].weight || (edges[a].weight == edges[b].weight && a < b);
+    };
+    auto offer = [&](uint32_t root, uint32_t e) {
+        std::atomic_ref<uint32_t> slot(best[root]);
+        uint32_t current = slot.load(std::memory_order_relaxed);
+        while ((current == NONE || lighter(e, current)) && !slot.compare_exchange_weak(current, e, std::memory_order_relaxed)) {}
+    };
+
+    while (!live.empty()) {
+        std::vector<uint32_t> kept(live.size());
+        std::atomic<size_t> kept_count = 0;
+        parallel::for_chunks(0, live.size(), [&](size_t, size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const auto& e = edges[live[i]];
+                uint32_t ru = sets.find(e.u), rv = sets.find(e.v);
+                if (ru == rv) continue;
+                kept[kept_count++] = live[i];
+                offer(ru, live[i]);
+                offer(rv, live[i]);
+            }
+        }, pool, 4096);
+        kept.resize(kept_count);
+        live.swap(kept);
+        if (live.empty()) break;
+
+        parallel::for_chunks(0, g.size(), [&](size_t t, size_t first, size_t last) {
+            for (size_t root = first; root < last; ++root) {
+                if (best[root] == NONE) continue;
+                uint32_t e = best[root];
+                best[root] = NONE;
+                if (sets.unite(edges[e].u, edges[e].v)) picked[t].push_back(e);
+            }
+        }, pool, 4096);
+        for (auto& p : picked) {
+            for (uint32_t e : p) {
+                forest.edges.push_back({edges[e].u, edges[e].v, edges[e].weight});
+                forest.weight += edges[e].weight;
+            }
+            p.clear();
+        }
     }
+    return forest;
+}
 
-    // Perform Bellman-Ford algorithm and print the shortest path from the source
-    bool run(int source) {
-        dist[source] = 0; // Distance to the source node is 0
+// Reordering
+//
+// Each ordering returns perm with perm[old id] = new id, and relabel() builds the renumbered graph. Node keys
+// move with their ids, so key-level results are unchanged and only memory locality differs. Orderings follow
+// edges in both directions (reverse must be g.transpose()).
 
-        // Relax all edges (n - 1) times
-        for (int i = 1; i < n; ++i) {
-            for (auto& edge : adj[i]) {
-                if (dist[edge.u] != INF && dist[edge.u] + edge.weight < dist[edge.v]) {
-                    dist[edge.v] = dist[edge.u] + edge.weight;
+namespace reorder_detail {
+
+template <typename T>
+uint32_t total_degree(const CsrGraph<T>& g, const CsrGraph<T>& reverse, uint32_t u) { return g.degree(u) + reverse.degree(u); }
+
+struct Sweep {
+    size_t levels;
+    size_t last_level; // where the deepest level starts in the visit order
+};
+
+// Appends the unseen nodes reachable from root to visit in breadth-first order and marks them seen. With
+// by_degree, the new neighbours of each node are queued lowest total degree first (Cuthill-McKee).
+template <typename T>
+Sweep sweep(const CsrGraph<T>& g, const CsrGraph<T>& reverse, uint32_t root, bool by_degree, std::vector<uint8_t>& seen,
+            std::vector<uint32_t>& visit) {
+    Sweep ret = {0, visit.size()};
+    size_t head = visit.size();
+    seen[root] = 1;
+    visit.push_back(root);
+    while (head < visit.size()) {
+        ++ret.levels;
+        ret.last_level = head;
+        for (size_t end = visit.size(); head < end; ++head) {
+            uint32_t u = visit[head];
+            size_t first = visit.size();
+            for (const CsrGraph<T>* side : {&g, &reverse}) {
+                for (uint32_t v : side->targets(u)) {
+                    if (seen[v]) continue;
+                    seen[v] = 1;
+                    visit.push_back(v);
                 }
             }
+            if (!by_degree) continue;
+            std::sort(visit.begin() + first, visit.end(), [&](uint32_t a, uint32_t b) {
+                return std::make_pair(total_degree(g, reverse, a), a) < std::make_pair(total_degree(g, reverse, b), b);
+            });
         }
+    }
+    return ret;
+}
 
-        // Check for negative weight cycles
-        for (auto& edge : adj) {
-            if (dist[edge.u] != INF && dist[edge.u] + edge.weight < dist[edge.v]) {
-                std::cout << "Graph contains a negative weight cycle.\n";
-                return false;
-            }
+inline std::vector<uint32_t> inverse(const std::vector<uint32_t>& order) { // visit order -> perm
+    std::vector<uint32_t> perm(order.size());
+    for (uint32_t i = 0; i < order.size(); ++i) perm[order[i]] = i;
+    return perm;
+}
+
+}
+
+// Reverse Cuthill-McKee: each component is swept Cuthill-McKee style from a pseudo-peripheral node, and the
+// whole order is reversed. The root is found by restarting from the lowest-degree node of the deepest level
+// until the depth stops growing. Neighbours get nearby ids, so adjacency rows touch a narrow band of memory.
+template <typename T>
+std::vector<uint32_t> reverse_cuthill_mckee(const CsrGraph<T>& g, const CsrGraph<T>& reverse) {
+    using namespace reorder_detail;
+    const size_t n = g.size();
+    std::vector<uint32_t> by_degree(n), order, component;
+    std::iota(by_degree.begin(), by_degree.end(), 0);
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&](uint32_t a, uint32_t b) {
+        return total_degree(g, reverse, a) < total_degree(g, reverse, b);
+    });
+    std::vector<uint8_t> seen(n, 0), probe(n, 0);
+    order.reserve(n);
+    for (uint32_t root : by_degree) {
+        if (seen[root]) continue;
+        for (size_t depth = 0;;) {
+            component.clear();
+            Sweep s = sweep(g, reverse, root, false, probe, component);
+            for (uint32_t v : component) probe[v] = 0;
+            if (s.levels <= depth) break;
+            depth = s.levels;
+            root = *std::min_element(component.begin() + s.last_level, component.end(), [&](uint32_t a, uint32_t b) {
+                return total_degree(g, reverse, a) < total_degree(g, reverse, b);
+            });
         }
+        sweep(g, reverse, root, true, seen, order);
+    }
+    std::reverse(order.begin(), order.end());
+    return inverse(order);
+}
 
-        // Print the shortest distances
-        std::cout << "Shortest distances from source node " << source << ":\n";
-        for (int i = 0; i < n; ++i) {
-            if (dist[i] == INF)
-                std::cout << "Node " << i << ": INF\n";
-            else
-                std::cout << "Node " << i << ": " << dist[i] << "\n";
+template <typename T>
+std::vector<uint32_t> reverse_cuthill_mckee(const CsrGraph<T>& g) { return reverse_cuthill_mckee(g, g.transpose()); }
+
+// Breadth-first order, restarting from the lowest unseen id for each component.
+template <typename T>
+std::vector<uint32_t> bfs_order(const CsrGraph<T>& g, const CsrGraph<T>& reverse) {
+    std::vector<uint8_t> seen(g.size(), 0);
+    std::vector<uint32_t> order;
+    order.reserve(g.size());
+    for (uint32_t root = 0; root < g.size(); ++root) {
+        if (!seen[root]) reorder_detail::sweep(g, reverse, root, false, seen, order);
+    }
+    return reorder_detail::inverse(order);
+}
+
+template <typename T>
+std::vector<uint32_t> bfs_order(const CsrGraph<T>& g) { return bfs_order(g, g.transpose()); }
+
+// Highest total degree first, ties by id, so the hubs most traversals touch share a few cache lines.
+template <typename T>
+std::vector<uint32_t> degree_order(const CsrGraph<T>& g) {
+    std::vector<uint32_t> degree(g.size(), 0), order(g.size());
+    for (uint32_t u = 0; u < g.size(); ++u) degree[u] += g.degree(u);
+    for (uint32_t v : g.targets()) ++degree[v];
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return degree[a] > degree[b]; });
+    return reorder_detail::inverse(order);
+}
+
+// The same graph with node old renumbered perm[old].
+template <typename T>
+CsrGraph<T> relabel(const CsrGraph<T>& g, const std::vector<uint32_t>& perm, parallel::ThreadPool& pool = parallel::default_pool()) {
+    const size_t n = g.size();
+    std::vector<uint32_t> old(n, NO_NODE);
+    if (perm.size() != n) throw std::invalid_argument("relabel needs one new id per node");
+    for (uint32_t u = 0; u < n; ++u) {
+        if (perm[u] >= n || old[perm[u]] != NO_NODE) throw std::invalid_argument("relabel needs a permutation");
+        old[perm[u]] = u;
+    }
+    std::vector<T> keys;
+    keys.reserve(n);
+    for (uint32_t u : old) keys.push_back(g.key(u));
+    std::vector<size_t> offsets(n + 1, 0);
+    for (uint32_t u = 0; u < n; ++u) offsets[u + 1] = offsets[u] + g.degree(old[u]);
+    std::vector<uint32_t> targets(g.edge_count());
+    std::vector<double> weights(g.edge_count());
+    parallel::for_each(0, n, [&](size_t u) {
+        auto row = g.targets(old[u]);
+        auto row_weights = g.weights(old[u]);
+        for (size_t i = 0; i < row.size(); ++i) {
+            targets[offsets[u] + i] = perm[row[i]];
+            weights[offsets[u] + i] = row_weights[i];
         }
-        return true;
+    }, pool, 256);
+    CsrGraph<T> ret(std::move(keys));
+    ret.assign_edges(std::move(offsets), std::move(targets), std::move(weights));
+    return ret;
+}
+
+// Maximum flow
+
+// Residual network in O(V + E) memory. Added edge i is stored as residual edge 2i and its reverse as 2i + 1, so
+// e ^ 1 is always the partner of e. Out-edges are grouped by tail, CSR-style, before the first solve.
+template <typename Cap = double>
+class FlowNetwork {
+    size_t _n;
+    std::vector<uint32_t> _to; // residual edge -> head
+    std::vector<Cap> _capacity; // residual edge -> capacity (0 for reverse edges)
+    std::vector<Cap> _residual; // residual edge -> remaining capacity
+    std::vector<size_t> _first; // node -> first slot in _out, _n + 1 entries
+    std::vector<size_t> _out; // residual edges grouped by tail
+    bool _indexed = false;
+
+    uint32_t tail(size_t e) const { return _to[e ^ 1]; }
+
+    void index() {
+        if (_indexed) return;
+        _first.assign(_n + 1, 0);
+        for (size_t e = 0; e < _to.size(); ++e) ++_first[tail(e) + 1];
+        for (size_t u = 0; u < _n; ++u) _first[u + 1] += _first[u];
+        std::vector<size_t> fill(_first.begin(), _first.end() - 1);
+        _out.resize(_to.size());
+        for (size_t e = 0; e < _to.size(); ++e) _out[fill[tail(e)]++] = e;
+        _indexed = true;
     }
 
-private:
-    int n; // Number of nodes
-    std::vector<int> dist; // Distance vector
-    std::vector<std::vector<Edge>> adj; // Adjacency list for the graph
-    static const int INF = std::numeric_limits<int>::max(); // Represent infinity
-};
+    void check(uint32_t source, uint32_t sink) const {
+        if (source >= _n) throw NonexistentNode(source);
+        if (sink >= _n) throw NonexistentNode(sink);
+        if (source == sink) throw std::invalid_argument("Source and sink must be different nodes.");
+    }
 
-// Ford-Fulkerson
+    // Fills dist with residual hop counts to (to_root) or from root; unreachable nodes get NO_NODE.
+    void residual_bfs(uint32_t root, bool to_root, std::vector<uint32_t>& dist, std::vector<uint32_t>& queue) const {
+        std::fill(dist.begin(), dist.end(), NO_NODE);
+        dist[root] = 0;
+        queue.assign(1, root);
+        for (size_t i = 0; i < queue.size(); ++i) {
+            uint32_t u = queue[i];
+            for (size_t slot = _first[u]; slot < _first[u + 1]; ++slot) {
+                size_t e = _out[slot];
+                uint32_t v = _to[e];
+                if (dist[v] != NO_NODE || !(_residual[to_root ? e ^ 1 : e] > 0)) continue;
+                dist[v] = dist[u] + 1;
+                queue.push_back(v);
+            }
+        }
+    }
 
-class FordFulkerson {
 public:
-    FordFulkerson(int n) : n(n), graph(n, std::vector<int>(n, 0)), residual(n, std::vector<int>(n, 0)) {}
-
-    // Add an edge with a given capacity from u to v
-    void addEdge(int u, int v, int capacity) {
-        graph[u][v] = capacity; // original graph with capacities
-        residual[u][v] = capacity; // residual graph initially equals to the original graph
-    }
-
-    // Perform DFS to find an augmenting path from source to sink
-    bool dfs(int u, int t, std::vector<int>& parent) {
-        std::vector<bool> visited(n, false);
-        visited[u] = true;
-        parent[u] = -1;
-
-        // Create a stack for DFS
-        std::queue<int> q;
-        q.push(u);
-
-        while (!q.empty()) {
-            int node = q.front();
-            q.pop();
-
-            // Explore all neighbors
-            for (int v = 0; v < n; ++v) {
-                if (!visited[v] && residual[node][v] > 0) {
-                    q.push(v);
-                    visited[v] = true;
-                    parent[v] = node;
-                    if (v == t) return true; // If we reached the sink, stop the search
-                }
-            }
+    explicit FlowNetwork(size_t n) : _n(n) {}
+
+    // one flow edge per graph edge, with the weight as capacity; flow edge i is CSR edge i
+    template <typename T>
+    explicit FlowNetwork(const CsrGraph<T>& g) : _n(g.size()) {
+        _to.reserve(2 * g.edge_count());
+        _capacity.reserve(2 * g.edge_count());
+        _residual.reserve(2 * g.edge_count());
+        for (uint32_t u = 0; u < g.size(); ++u) {
+            auto targets = g.targets(u);
+            auto weights = g.weights(u);
+            for (size_t i = 0; i < targets.size(); ++i) add_edge(u, targets[i], weights[i]);
         }
-        return false; // No augmenting path found
     }
 
-    // Ford-Fulkerson algorithm to compute maximum flow
-    int computeMaxFlow(int source, int sink) {
-        std::vector<int> parent(n);
-        int maxFlow = 0;
+    size_t size() const { return _n; }
+    size_t edge_count() const { return _to.size() / 2; }
+
+    size_t add_edge(uint32_t begin, uint32_t end, Cap capacity) { // returns the edge's index
+        if (begin >= _n) throw NonexistentNode(begin);
+        if (end >= _n) throw NonexistentNode(end);
+        if (capacity < 0) throw std::invalid_argument("Capacities must be non-negative.");
+        _to.insert(_to.end(), {end, begin});
+        _capacity.insert(_capacity.end(), {capacity, Cap(0)});
+        _residual.insert(_residual.end(), {capacity, Cap(0)});
+        _indexed = false;
+        return _to.size() / 2 - 1;
+    }
 
-        // Augment the flow while there is an augmenting path
-        while (dfs(source, sink, parent)) {
-            // Find the maximum flow through the path found by DFS
-            int pathFlow = INT_MAX;
-            for (int v = sink; v != source; v = parent[v]) {
-                int u = parent[v];
-                pathFlow = std::min(pathFlow, residual[u][v]);
+    Cap capacity(size_t edge) const { return _capacity[2 * edge]; }
+    Cap flow(size_t edge) const { return _capacity[2 * edge] - _residual[2 * edge]; }
+    void reset() { _residual = _capacity; }
+
+    // Dinic: BFS levels, then blocking flows along level-increasing residual edges. arc[u] is the current arc,
+    // so every edge is skipped at most once per phase, and the search is iterative so long paths cannot
+    // overflow the stack.
+    Cap dinic(uint32_t source, uint32_t sink) {
+        check(source, sink);
+        index();
+        Cap total = 0;
+        std::vector<uint32_t> level(_n), queue;
+        std::vector<size_t> arc(_n), path;
+        while (true) {
+            residual_bfs(source, false, level, queue);
+            if (level[sink] == NO_NODE) break;
+            std::copy(_first.begin(), _first.end() - 1, arc.begin());
+            uint32_t u = source;
+            path.clear();
+            while (true) {
+                if (u == sink) {
+                    Cap push = _residual[path[0]];
+                    for (size_t e : path) push = std::min(push, _residual[e]);
+                    size_t saturated = path.size();
+                    for (size_t i = 0; i < path.size(); ++i) {
+                        _residual[path[i]] -= push;
+                        _residual[path[i] ^ 1] += push;
+                        if (saturated == path.size() && !(_residual[path[i]] > 0)) saturated = i;
+                    }
+                    total += push;
+                    u = tail(path[saturated]);
+                    path.resize(saturated);
+                    continue;
+                }
+                size_t& a = arc[u];
+                while (a < _first[u + 1] && !(_residual[_out[a]] > 0 && level[_to[_out[a]]] == level[u] + 1)) ++a;
+                if (a < _first[u + 1]) {
+                    path.push_back(_out[a]);
+                    u = _to[_out[a]];
+                    continue;
+                }
+                if (u == source) break;
+                level[u] = NO_NODE; // dead end for the rest of this phase
+                u = tail(path.back());
+                path.pop_back();
+                ++arc[u];
             }
+        }
+        return total;
+    }
 
-            // Update the residual graph
-            for (int v = sink; v != source; v = parent[v]) {
-                int u = parent[v];
-                residual[u][v] -= pathFlow;
-                residual[v][u] += pathFlow;
+    // Highest-label push-relabel with the gap heuristic and periodic global relabeling (exact heights from a
+    // reverse BFS from the sink). A second phase returns leftover excess to the source so flow() is a valid flow.
+    Cap push_relabel(uint32_t source, uint32_t sink) {
+        check(source, sink);
+        index();
+        const uint32_t n = _n;
+        std::vector<uint32_t> height(n), slot(n), queue;
+        std::vector<Cap> excess(n, Cap(0));
+        std::vector<size_t> arc(n);
+        std::vector<std::vector<uint32_t>> active(n), members(n); // by height < n; members holds every such node
+        uint32_t highest = 0, tallest = 0; // bounds on the highest active node and the highest member
+        size_t work = 0;
+
+        auto set_height = [&](uint32_t u, uint32_t h) {
+            if (height[u] < n) {
+                auto& from = members[height[u]];
+                members[height[u]][slot[u]] = from.back();
+                slot[from.back()] = slot[u];
+                from.pop_back();
+            }
+            height[u] = h;
+            if (h < n) {
+                slot[u] = members[h].size();
+                members[h].push_back(u);
+                tallest = std::max(tallest, h);
             }
+        };
+        auto activate = [&](uint32_t u) {
+            if (u == source || u == sink || height[u] >= n) return;
+            active[height[u]].push_back(u);
+            highest = std::max(highest, height[u]);
+        };
+        auto global_relabel = [&] {
+            for (uint32_t h = 0; h <= std::min(tallest, n - 1); ++h) {
+                active[h].clear();
+                members[h].clear();
+            }
+            highest = tallest = 0;
+            residual_bfs(sink, true, height, queue);
+            height[source] = n;
+            for (uint32_t u = 0; u < n; ++u) {
+                if (height[u] == NO_NODE) height[u] = n;
+                if (height[u] < n) {
+                    uint32_t h = height[u];
+                    height[u] = n; // so set_height does not try to unlink it
+                    set_height(u, h);
+                }
+                if (excess[u] > 0) activate(u);
+                arc[u] = _first[u];
+            }
+        };
+        auto push = [&](size_t e, Cap amount) {
+            uint32_t v = _to[e];
+            bool was_idle = !(excess[v] > 0);
+            _residual[e] -= amount;
+            _residual[e ^ 1] += amount;
+            excess[tail(e)] -= amount;
+            excess[v] += amount;
+            if (was_idle) activate(v);
+        };
+
+        std::fill(height.begin(), height.end(), n);
+        for (size_t a = _first[source]; a < _first[source + 1]; ++a) {
+            if (_residual[_out[a]] > 0) push(_out[a], _residual[_out[a]]);
+        }
+        global_relabel();
+
+        while (true) {
+            while (highest > 0 && active[highest].empty()) --highest;
+            if (active[highest].empty()) break;
+            uint32_t u = active[highest].back();
+            active[highest].pop_back();
+            if (height[u] != highest || !(excess[u] > 0)) continue; // lifted by a gap since it was queued
+            while (excess[u] > 0) {
+                if (arc[u] == _first[u + 1]) {
+                    uint32_t old = height[u];
+                    if (members[old].size() == 1) { // gap: nothing above old can reach the sink any more
+                        for (uint32_t h = old; h <= tallest; ++h) {
+                            for (uint32_t v : members[h]) height[v] = n;
+                            members[h].clear();
+                            active[h].clear();
+                        }
+                        tallest = old > 0 ? old - 1 : 0;
+                        break;
+                    }
+                    uint32_t lowest = n;
+                    for (size_t a = _first[u]; a < _first[u + 1]; ++a) {
+                        if (_residual[_out[a]] > 0) lowest = std::min(lowest, height[_to[_out[a]]] + 1);
+                    }
+                    work += _first[u + 1] - _first[u] + 12;
+                    arc[u] = _first[u];
+                    set_height(u, std::min(lowest, n));
+                    if (height[u] >= n) break;
+                    continue;
+                }
+                size_t e = _out[arc[u]];
+                if (_residual[e] > 0 && height[u] == height[_to[e]] + 1) push(e, std::min(excess[u], _residual[e]));
+                else ++arc[u];
+            }
+            if (work > 6 * size_t(n) + _to.size() / 2) {
+                global_relabel();
+                work = 0;
+            }
+        }
 
-            maxFlow += pathFlow; // Add the flow of this augmenting path to the total flow
+        // Phase two: nodes still holding excess cannot reach the sink; FIFO-discharge them back to the source
+        // with heights seeded from residual distances to it.
+        queue.clear();
+        for (uint32_t u = 0; u < n; ++u) {
+            if (u != source && u != sink && excess[u] > 0) queue.push_back(u);
         }
+        if (!queue.empty()) {
+            std::vector<uint32_t> pending = std::move(queue);
+            residual_bfs(source, true, height, queue);
+            height[sink] = NO_NODE;
+            std::copy(_first.begin(), _first.end() - 1, arc.begin());
+            for (size_t i = 0; i < pending.size(); ++i) {
+                uint32_t u = pending[i];
+                while (excess[u] > 0) {
+                    if (arc[u] == _first[u + 1]) {
+                        uint32_t lowest = NO_NODE;
+                        for (size_t a = _first[u]; a < _first[u + 1]; ++a) {
+                            uint32_t h = height[_to[_out[a]]];
+                            if (_residual[_out[a]] > 0 && h != NO_NODE) lowest = std::min(lowest, h + 1);
+                        }
+                        height[u] = lowest;
+                        arc[u] = _first[u];
+                        continue;
+                    }
+                    size_t e = _out[arc[u]];
+                    uint32_t v = _to[e];
+                    if (_residual[e] > 0 && height[v] != NO_NODE && height[u] == height[v] + 1) {
+                        bool was_idle = !(excess[v] > 0);
+                        Cap amount = std::min(excess[u], _residual[e]);
+                        _residual[e] -= amount;
+                        _residual[e ^ 1] += amount;
+                        excess[u] -= amount;
+                        excess[v] += amount;
+                        if (was_idle && v != source) pending.push_back(v);
+                    } else {
+                        ++arc[u];
+                    }
+                }
+            }
+        }
+        return excess[sink];
+    }
 
-        return maxFlow;
+    // Source side of a minimum cut after a max-flow solve: the nodes reachable from source in the residual network.
+    std::vector<bool> min_cut(uint32_t source) {
+        if (source >= _n) throw NonexistentNode(source);
+        index();
+        std::vector<uint32_t> dist(_n), queue;
+        residual_bfs(source, false, dist, queue);
+        std::vector<bool> ret(_n);
+        for (uint32_t u = 0; u < _n; ++u) ret[u] = dist[u] != NO_NODE;
+        return ret;
     }
 
-private:
-    int n; // Number of nodes
-    std::vector<std::vector<int>> graph; // Original graph with capacities
-    std::vector<std::vector<int>> residual; // Residual graph with remaining capacities
+    std::vector<size_t> cut_edges(uint32_t source) { // indices of the edges crossing min_cut(source)
+        std::vector<bool> side = min_cut(source);
+        std::vector<size_t> ret;
+        for (size_t e = 0; e < _to.size(); e += 2) {
+            if (side[tail(e)] && !side[_to[e]]) ret.push_back(e / 2);
+        }
+        return ret;
+    }
 };
 
 #endif // GRAPH_HPP
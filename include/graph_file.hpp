@@ -0,0 +1,221 @@
+#ifndef GRAPH_FILE_HPP
+#define GRAPH_FILE_HPP
+
+#include <cerrno>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "graph.hpp"
+
+// On-disk CSR graphs that open without parsing: write_csr() lays out a header followed by the key table,
+// offsets, targets and weights, each 64-byte aligned, and open_csr() maps the file read-only and hands
+// CsrGraph views straight into the mapping, so pages load lazily as they are first touched.
+//
+// The arrays are stored in native byte order and width; the header records both, and a file written on a
+// machine that disagrees is rejected rather than converted. Trivially copyable keys are stored as an array of
+// their bytes. String keys (std::string or std::string_view) are stored as nodes + 1 uint64_t offsets followed
+// by the characters of every key back to back; open_csr<std::string_view>() views them in place, at the cost of
+// building one string_view per node, and open_csr<std::string>() copies them out.
+
+class BadGraphFile : public std::runtime_error {
+public:
+    explicit BadGraphFile(const std::string& path, const std::string& why) : std::runtime_error(path + " is not a usable graph file: " + why) {}
+};
+
+namespace graph_file {
+
+constexpr char MAGIC[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t ENDIAN_MARK = 0x01020304; // reads back differently on a machine of the other endianness
+constexpr uint64_t ALIGNMENT = 64;
+constexpr uint32_t TEXT_KEYS = 0; // key_size of a file whose keys are strings
+
+template <typename T>
+concept TextKey = std::same_as<T, std::string> || std::same_as<T, std::string_view>;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t key_size;
+    uint32_t offset_size;
+    uint64_t nodes;
+    uint64_t edges;
+    uint64_t keys_at; // byte positions of the arrays from the start of the file
+    uint64_t offsets_at;
+    uint64_t targets_at;
+    uint64_t weights_at;
+    uint64_t file_size;
+};
+
+inline uint64_t align(uint64_t n) { return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+template <typename T>
+uint32_t key_size() {
+    if constexpr (TextKey<T>) return TEXT_KEYS;
+    else return sizeof(T);
+}
+// Where the characters of string keys start, after their offsets.
+inline uint64_t text_at(const Header& header) { return align(header.keys_at + (header.nodes + 1) * sizeof(uint64_t)); }
+
+// Read-only mapping of a whole file; unmapped when the last graph viewing it goes away.
+class MappedFile {
+    void* _data = MAP_FAILED;
+    size_t _size = 0;
+
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+        struct stat info;
+        if (::fstat(fd, &info) < 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "stat " + path);
+        }
+        _size = info.st_size;
+        if (_size > 0) _data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        int error = errno;
+        ::close(fd); // the mapping stays valid without the descriptor
+        if (_size > 0 && _data == MAP_FAILED) throw std::system_error(error, std::generic_category(), "mmap " + path);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (_data != MAP_FAILED) ::munmap(_data, _size);
+    }
+
+    const char* data() const { return static_cast<const char*>(_data); }
+    size_t size() const { return _size; }
+};
+
+template <typename U>
+std::span<const U> view(const MappedFile& file, uint64_t at, uint64_t count) {
+    return std::span<const U>(reinterpret_cast<const U*>(file.data() + at), count);
+}
+
+// String keys of a mapped file, and the mapping they point into.
+template <typename T>
+struct TextKeys {
+    std::shared_ptr<const MappedFile> file;
+    std::vector<T> keys;
+};
+
+}
+
+template <typename T>
+void write_csr(const CsrGraph<T>& g, const std::string& path) {
+    static_assert(std::is_trivially_copyable_v<T> || graph_file::TextKey<T>, "write_csr stores keys as raw bytes or strings");
+    using namespace graph_file;
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = ENDIAN_MARK;
+    header.key_size = key_size<T>();
+    header.offset_size = sizeof(size_t);
+    header.nodes = g.size();
+    header.edges = g.edge_count();
+    header.keys_at = align(sizeof(Header));
+    std::vector<uint64_t> key_offsets = {0};
+    std::string text;
+    if constexpr (TextKey<T>) {
+        for (const T& key : g.keys()) {
+            text += key;
+            key_offsets.push_back(text.size());
+        }
+        header.offsets_at = align(text_at(header) + text.size());
+    } else {
+        header.offsets_at = align(header.keys_at + header.nodes * sizeof(T));
+    }
+    header.targets_at = align(header.offsets_at + (header.nodes + 1) * sizeof(size_t));
+    header.weights_at = align(header.targets_at + header.edges * sizeof(uint32_t));
+    header.file_size = header.weights_at + header.edges * sizeof(double);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::system_error(errno, std::generic_category(), "create " + path);
+    auto put = [&](uint64_t at, const auto& array) {
+        static const char zeros[ALIGNMENT] = {};
+        out.write(zeros, at - out.tellp());
+        out.write(reinterpret_cast<const char*>(array.data()), array.size_bytes());
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if constexpr (TextKey<T>) {
+        put(header.keys_at, std::span<const uint64_t>(key_offsets));
+        put(text_at(header), std::span<const char>(text));
+    } else {
+        put(header.keys_at, g.keys());
+    }
+    put(header.offsets_at, g.offsets());
+    put(header.targets_at, g.targets());
+    put(header.weights_at, g.weights());
+    if (!out.flush()) throw std::system_error(errno, std::generic_category(), "write " + path);
+}
+
+template <typename T>
+void write_csr(const Graph<T>& g, const std::string& path) { write_csr(g.freeze(), path); }
+
+// Throws BadGraphFile if the file is not a CSR graph of this key type written on a compatible machine.
+// Only the header and string key offsets are checked; the other arrays are trusted to be what write_csr() wrote.
+template <typename T>
+CsrGraph<T> open_csr(const std::string& path) {
+    static_assert(std::is_trivially_copyable_v<T> || graph_file::TextKey<T>, "open_csr views keys as raw bytes or strings");
+    using namespace graph_file;
+    auto file = std::make_shared<const MappedFile>(path);
+    Header header;
+    if (file->size() < sizeof(Header)) throw BadGraphFile(path, "too short");
+    std::memcpy(&header, file->data(), sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) throw BadGraphFile(path, "bad magic number");
+    if (header.version != VERSION) throw BadGraphFile(path, "unsupported version " + std::to_string(header.version));
+    if (header.byte_order != ENDIAN_MARK) throw BadGraphFile(path, "written with another byte order");
+    if (header.key_size != key_size<T>()) throw BadGraphFile(path, "key size does not match");
+    if (header.offset_size != sizeof(size_t)) throw BadGraphFile(path, "offset width does not match");
+    uint64_t keys_end = header.keys_at + header.nodes * sizeof(T);
+    if constexpr (TextKey<T>) {
+        if (header.keys_at != align(sizeof(Header)) || text_at(header) > file->size()) {
+            throw BadGraphFile(path, "truncated or inconsistent sizes");
+        }
+        keys_end = text_at(header) + view<uint64_t>(*file, header.keys_at, header.nodes + 1).back();
+    }
+    bool laid_out = header.keys_at == align(sizeof(Header))
+        && header.offsets_at == align(keys_end)
+        && header.targets_at == align(header.offsets_at + (header.nodes + 1) * sizeof(size_t))
+        && header.weights_at == align(header.targets_at + header.edges * sizeof(uint32_t))
+        && header.file_size == header.weights_at + header.edges * sizeof(double);
+    if (!laid_out || header.file_size != file->size()) throw BadGraphFile(path, "truncated or inconsistent sizes");
+    if constexpr (TextKey<T>) {
+        auto key_offsets = view<uint64_t>(*file, header.keys_at, header.nodes + 1);
+        auto text = std::make_shared<TextKeys<T>>();
+        text->file = file;
+        text->keys.reserve(header.nodes);
+        for (uint64_t u = 0; u < header.nodes; ++u) {
+            if (key_offsets[u] > key_offsets[u + 1]) throw BadGraphFile(path, "string key offsets out of order");
+            text->keys.emplace_back(file->data() + text_at(header) + key_offsets[u], key_offsets[u + 1] - key_offsets[u]);
+        }
+        std::span<const T> keys = text->keys;
+        return CsrGraph<T>(std::move(text), keys,
+                           view<size_t>(*file, header.offsets_at, header.nodes + 1),
+                           view<uint32_t>(*file, header.targets_at, header.edges),
+                           view<double>(*file, header.weights_at, header.edges));
+    }
+    return CsrGraph<T>(file, view<T>(*file, header.keys_at, header.nodes),
+                       view<size_t>(*file, header.offsets_at, header.nodes + 1),
+                       view<uint32_t>(*file, header.targets_at, header.edges),
+                       view<double>(*file, header.weights_at, header.edges));
+}
+
+#endif // GRAPH_FILE_HPP
@@ -0,0 +1,253 @@
+#ifndef HEAP_HPP
+#define HEAP_HPP
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Indexed min-heaps over ids [0, n). They share one interface so graph algorithms can take the heap as a
+// template parameter:
+//     Heap heap(n);
+//     heap.push(id, key);         // insert, or lower the key of an id already in the heap
+//     auto [id, key] = heap.pop();
+// DaryHeap and PairingHeap also have top(), which peeks at the minimum without removing it.
+// DaryHeap and PairingHeap decrease keys in place, so every pop is live. RadixHeap is lazy: a push for an
+// id already in the heap adds a second entry, and callers must skip pops whose key is out of date.
+
+class EmptyHeap : public std::range_error {
+public:
+    explicit EmptyHeap() : std::range_error("Heap is empty") {}
+};
+
+template <unsigned D = 4>
+class DaryHeap {
+    static_assert(D >= 2, "DaryHeap needs at least two children per node");
+    static constexpr uint32_t ABSENT = std::numeric_limits<uint32_t>::max();
+
+    std::vector<std::pair<double, uint32_t>> _heap; // key, id
+    std::vector<uint32_t> _pos; // id -> slot in _heap
+
+    void place(size_t slot, std::pair<double, uint32_t> entry) {
+        _heap[slot] = entry;
+        _pos[entry.second] = slot;
+    }
+    void sift_up(size_t slot) {
+        auto entry = _heap[slot];
+        while (slot > 0) {
+            size_t parent = (slot - 1) / D;
+            if (_heap[parent].first <= entry.first) break;
+            place(slot, _heap[parent]);
+            slot = parent;
+        }
+        place(slot, entry);
+    }
+    void sift_down(size_t slot) {
+        auto entry = _heap[slot];
+        while (true) {
+            size_t first = slot * D + 1;
+            if (first >= _heap.size()) break;
+            size_t last = std::min(first + D, _heap.size()), best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (_heap[c].first < _heap[best].first) best = c;
+            }
+            if (entry.first <= _heap[best].first) break;
+            place(slot, _heap[best]);
+            slot = best;
+        }
+        place(slot, entry);
+    }
+
+public:
+    explicit DaryHeap(size_t n = 0) : _pos(n, ABSENT) {}
+
+    bool empty() const { return _heap.empty(); }
+    size_t size() const { return _heap.size(); }
+    bool contains(uint32_t id) const { return _pos[id] != ABSENT; }
+    double key(uint32_t id) const { return _heap[_pos[id]].first; }
+
+    std::pair<uint32_t, double> top() const {
+        if (_heap.empty()) throw EmptyHeap();
+        return {_heap.front().second, _heap.front().first};
+    }
+
+    void push(uint32_t id, double key) {
+        if (id >= _pos.size()) _pos.resize(id + 1, ABSENT);
+        if (_pos[id] == ABSENT) {
+            _heap.push_back({key, id});
+            sift_up(_heap.size() - 1);
+        } else if (key < _heap[_pos[id]].first) {
+            _heap[_pos[id]].first = key;
+            sift_up(_pos[id]);
+        }
+    }
+
+    std::pair<uint32_t, double> pop() {
+        if (_heap.empty()) throw EmptyHeap();
+        auto [key, id] = _heap.front();
+        _pos[id] = ABSENT;
+        auto back = _heap.back();
+        _heap.pop_back();
+        if (!_heap.empty()) {
+            _heap.front() = back;
+            sift_down(0);
+        }
+        return {id, key};
+    }
+
+    void clear() {
+        for (const auto& entry : _heap) _pos[entry.second] = ABSENT;
+        _heap.clear();
+    }
+};
+
+using BinaryHeap = DaryHeap<2>;
+
+class PairingHeap {
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+        double key;
+        uint32_t child = NONE;
+        uint32_t sibling = NONE;
+        uint32_t prev = NONE; // parent if leftmost child, otherwise left sibling
+        bool in_heap = false;
+    };
+    std::vector<Node> _nodes; // indexed by id
+    std::vector<uint32_t> _scratch; // reused by merge_pairs
+    uint32_t _root = NONE;
+    size_t _size = 0;
+
+    uint32_t meld(uint32_t a, uint32_t b) {
+        if (a == NONE) return b;
+        if (b == NONE) return a;
+        if (_nodes[b].key < _nodes[a].key) std::swap(a, b);
+        _nodes[b].prev = a;
+        _nodes[b].sibling = _nodes[a].child;
+        if (_nodes[a].child != NONE) _nodes[_nodes[a].child].prev = b;
+        _nodes[a].child = b;
+        return a;
+    }
+    uint32_t merge_pairs(uint32_t first) { // standard two-pass combine of a sibling list
+        _scratch.clear();
+        for (uint32_t n = first; n != NONE;) {
+            uint32_t next = _nodes[n].sibling;
+            _nodes[n].sibling = _nodes[n].prev = NONE;
+            _scratch.push_back(n);
+            n = next;
+        }
+        size_t pairs = 0;
+        for (size_t i = 0; i + 1 < _scratch.size(); i += 2) {
+            _scratch[pairs++] = meld(_scratch[i], _scratch[i + 1]);
+        }
+        if (_scratch.size() % 2 == 1) _scratch[pairs++] = _scratch.back();
+        uint32_t root = NONE;
+        while (pairs > 0) root = meld(_scratch[--pairs], root);
+        return root;
+    }
+    void cut(uint32_t n) {
+        Node& node = _nodes[n];
+        if (_nodes[node.prev].child == n) _nodes[node.prev].child = node.sibling;
+        else _nodes[node.prev].sibling = node.sibling;
+        if (node.sibling != NONE) _nodes[node.sibling].prev = node.prev;
+        node.sibling = node.prev = NONE;
+    }
+
+public:
+    explicit PairingHeap(size_t n = 0) : _nodes(n) {}
+
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+    bool contains(uint32_t id) const { return _nodes[id].in_heap; }
+    double key(uint32_t id) const { return _nodes[id].key; }
+
+    std::pair<uint32_t, double> top() const {
+        if (_root == NONE) throw EmptyHeap();
+        return {_root, _nodes[_root].key};
+    }
+
+    void push(uint32_t id, double key) {
+        if (id >= _nodes.size()) _nodes.resize(id + 1);
+        Node& node = _nodes[id];
+        if (!node.in_heap) {
+            node = Node{key};
+            node.in_heap = true;
+            ++_size;
+            _root = meld(_root, id);
+        } else if (key < node.key) {
+            node.key = key;
+            if (id == _root) return;
+            cut(id);
+            _root = meld(_root, id);
+        }
+    }
+
+    std::pair<uint32_t, double> pop() {
+        if (_root == NONE) throw EmptyHeap();
+        uint32_t id = _root;
+        _nodes[id].in_heap = false;
+        --_size;
+        _root = merge_pairs(_nodes[id].child);
+        _nodes[id].child = NONE;
+        return {id, _nodes[id].key};
+    }
+
+    void clear() {
+        while (!empty()) pop();
+    }
+};
+
+// Monotone heap for non-negative integer keys: every push must be >= the last popped key, which is what
+// Dijkstra with integer weights guarantees. Keys are double in the interface and must be whole numbers.
+class RadixHeap {
+    std::vector<std::pair<uint64_t, uint32_t>> _buckets[65]; // bucket i holds keys differing from _last first at bit i - 1
+    uint64_t _last = 0;
+    size_t _size = 0;
+
+    size_t bucket(uint64_t key) const { return key == _last ? 0 : 64 - std::countl_zero(key ^ _last); }
+
+public:
+    explicit RadixHeap(size_t = 0) {}
+
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+
+    void push(uint32_t id, double key) {
+        if (!(key >= 0) || key != std::floor(key) || key >= 0x1p64) {
+            throw std::invalid_argument("RadixHeap keys must be non-negative integers");
+        }
+        uint64_t k = key;
+        if (k < _last) throw std::invalid_argument("RadixHeap keys must not be below the last popped key");
+        _buckets[bucket(k)].push_back({k, id});
+        ++_size;
+    }
+
+    std::pair<uint32_t, double> pop() {
+        if (_size == 0) throw EmptyHeap();
+        if (_buckets[0].empty()) {
+            size_t i = 1;
+            while (_buckets[i].empty()) ++i;
+            uint64_t low = _buckets[i].front().first;
+            for (const auto& entry : _buckets[i]) low = std::min(low, entry.first);
+            _last = low;
+            for (const auto& entry : _buckets[i]) _buckets[bucket(entry.first)].push_back(entry);
+            _buckets[i].clear();
+        }
+        auto [key, id] = _buckets[0].back();
+        _buckets[0].pop_back();
+        --_size;
+        return {id, static_cast<double>(key)};
+    }
+
+    void clear() {
+        for (auto& b : _buckets) b.clear();
+        _last = 0;
+        _size = 0;
+    }
+};
+
+#endif // HEAP_HPP
@@ -0,0 +1,421 @@
+#ifndef INDEXED_LIST_HPP
+#define INDEXED_LIST_HPP
+
+#include "list.hpp"
+#include "unrolled_list.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// List with logarithmic positional access: the List interface, negative indices included, but operator[], insert
+// and del take O(log n + CAPACITY) instead of walking up to n / 2 nodes.
+//
+// Elements live in blocks of up to CAPACITY, like UnrolledList, and the blocks form an indexable skip list. Each
+// block has a tower of random height; the link on level i records the next block on that level and how many
+// elements lie between the two, so finding a position descends the levels summing widths. A full block splits
+// (the new half gets a fresh tower) and a block that falls below half full merges with a neighbour, each fixing
+// the widths along the search path. Any insert or delete invalidates iterators.
+template <typename T, size_t BlockBytes = 4 * CACHE_LINE>
+class IndexedList {
+public:
+    static constexpr size_t CAPACITY = std::max<size_t>(2, (BlockBytes - std::min<size_t>(BlockBytes, 16)) / sizeof(T));
+    static constexpr size_t MAX_LEVEL = 32;
+
+private:
+    struct Block;
+    struct Link {
+        Block* next;
+        size_t width; // elements from the start of this block to the start of next, or to the end of the list
+    };
+    struct alignas(Link) Block { // followed in memory by height links
+        Block* prev = nullptr; // on level 0; null for the first block
+        uint32_t count = 0;
+        uint32_t height;
+        alignas(T) std::byte storage[CAPACITY * sizeof(T)];
+
+        T* data() { return std::launder(reinterpret_cast<T*>(storage)); }
+        const T* data() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+        Link& link(size_t level) { return std::launder(reinterpret_cast<Link*>(this + 1))[level]; }
+        const Link& link(size_t level) const { return std::launder(reinterpret_cast<const Link*>(this + 1))[level]; }
+    };
+
+    static Block* new_block(size_t height) {
+        void* p = ::operator new(sizeof(Block) + height * sizeof(Link), std::align_val_t(alignof(Block)));
+        Block* b = new (p) Block;
+        b->height = height;
+        for (size_t i = 0; i < height; ++i) new (&b->link(i)) Link{nullptr, 0};
+        return b;
+    }
+    static void free_block(Block* b) {
+        b->~Block();
+        ::operator delete(b, std::align_val_t(alignof(Block)));
+    }
+
+    size_t _length = 0;
+    size_t _levels = 1; // levels of the head in use
+    Block* _head = new_block(MAX_LEVEL); // holds no elements and starts at 0, so it comes first on every level
+    Block* _back = nullptr;
+    std::minstd_rand _rng;
+
+    // Fills pred[i] with the last block on level i that starts before `start`, and rank[i] with where it starts.
+    void before(size_t start, Block** pred, size_t* rank) const {
+        Block* x = _head;
+        size_t r = 0;
+        for (size_t i = _levels; i-- > 0;) {
+            while (x->link(i).next && r + x->link(i).width < start) {
+                r += x->link(i).width;
+                x = x->link(i).next;
+            }
+            pred[i] = x;
+            rank[i] = r;
+        }
+    }
+    std::pair<Block*, size_t> locate(size_t pos) const { // pos < _length
+        Block* x = _head;
+        for (size_t i = _levels; i-- > 0;) {
+            while (x->link(i).next && x->link(i).width <= pos) {
+                pos -= x->link(i).width;
+                x = x->link(i).next;
+            }
+        }
+        return {x, pos};
+    }
+
+    // Moves the elements of b from k on into a new block right after it. pred and rank come from the search that
+    // picked b, so pred[0] == b; the new block's levels are spliced in after pred[i].
+    Block* split(Block* b, size_t k, Block** pred, size_t* rank) {
+        size_t height = std::min<size_t>(MAX_LEVEL, 1 + std::countr_zero(static_cast<uint32_t>(_rng())));
+        for (; _levels < height; ++_levels) {
+            _head->link(_levels) = {nullptr, _length};
+            pred[_levels] = _head;
+            rank[_levels] = 0;
+        }
+        Block* n = new_block(height);
+        std::uninitialized_move(b->data() + k, b->data() + b->count, n->data());
+        std::destroy(b->data() + k, b->data() + b->count);
+        n->count = b->count - k;
+        b->count = k;
+        size_t start = rank[0] + k;
+        for (size_t i = 0; i < height; ++i) {
+            Link& l = pred[i]->link(i);
+            n->link(i) = {l.next, rank[i] + l.width - start};
+            l = {n, start - rank[i]};
+        }
+        n->prev = b == _head ? nullptr : b;
+        (n->link(0).next ? n->link(0).next->prev : _back) = n;
+        return n;
+    }
+    // Takes b out of every level it is on, handing its widths to its predecessors, and frees it. b must be empty
+    // or already moved elsewhere, and start says where it starts.
+    void unlink(Block* b, size_t start) {
+        Block* pred[MAX_LEVEL];
+        size_t rank[MAX_LEVEL];
+        before(start, pred, rank);
+        for (size_t i = 0; i < b->height; ++i) {
+            pred[i]->link(i).next = b->link(i).next;
+            pred[i]->link(i).width += b->link(i).width;
+        }
+        (b->link(0).next ? b->link(0).next->prev : _back) = b->prev;
+        free_block(b);
+    }
+    // Appends the block after b, which starts at `start`, to b; the two must fit in one block.
+    void absorb(Block* b, size_t start) {
+        Block* n = b->link(0).next;
+        size_t n_start = start + b->count;
+        std::uninitialized_move(n->data(), n->data() + n->count, b->data() + b->count);
+        std::destroy(n->data(), n->data() + n->count);
+        b->count += n->count;
+        n->count = 0;
+        unlink(n, n_start);
+    }
+
+    static void insert_at(Block* b, size_t at, const T& val) { // b must have room
+        T* d = b->data();
+        if (at == b->count) {
+            new (d + at) T(val);
+        } else {
+            T copy(val); // val may be one of the elements about to shift
+            new (d + b->count) T(std::move(d[b->count - 1]));
+            std::move_backward(d + at, d + b->count - 1, d + b->count);
+            d[at] = std::move(copy);
+        }
+        ++b->count;
+    }
+
+    // Rebuilds every level from the block sequence, dropping empty blocks.
+    void reindex() {
+        Block* last[MAX_LEVEL];
+        size_t last_start[MAX_LEVEL];
+        std::fill(last, last + _levels, _head);
+        std::fill(last_start, last_start + _levels, 0);
+        Block* prev = nullptr;
+        size_t start = 0;
+        for (Block* b = _head->link(0).next; b;) {
+            Block* next = b->link(0).next;
+            if (b->count == 0) {
+                free_block(b);
+            } else {
+                for (size_t i = 0; i < b->height; ++i) {
+                    last[i]->link(i) = {b, start - last_start[i]};
+                    last[i] = b;
+                    last_start[i] = start;
+                }
+                b->prev = prev;
+                prev = b;
+                start += b->count;
+            }
+            b = next;
+        }
+        for (size_t i = 0; i < _levels; ++i) last[i]->link(i) = {nullptr, _length - last_start[i]};
+        _back = prev;
+    }
+
+public:
+
+    class iterator {
+        friend class IndexedList;
+        Block* _block;
+        size_t _index;
+    public:
+        iterator(Block* block = nullptr, size_t index = 0) : _block(block), _index(index) {}
+        iterator& operator++() {
+            if (++_index == _block->count) {
+                _block = _block->link(0).next;
+                _index = 0;
+            }
+            return *this;
+        }
+        iterator& operator--() {
+            if (_index == 0) {
+                _block = _block->prev;
+                _index = _block->count;
+            }
+            --_index;
+            return *this;
+        }
+        T& operator*() const { return _block->data()[_index]; }
+        bool operator==(const iterator& rhs) const { return _block == rhs._block && _index == rhs._index; }
+        bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    class const_iterator {
+        friend class IndexedList;
+        const Block* _block;
+        size_t _index;
+    public:
+        const_iterator(const Block* block = nullptr, size_t index = 0) : _block(block), _index(index) {}
+        const_iterator& operator++() {
+            if (++_index == _block->count) {
+                _block = _block->link(0).next;
+                _index = 0;
+            }
+            return *this;
+        }
+        const_iterator& operator--() {
+            if (_index == 0) {
+                _block = _block->prev;
+                _index = _block->count;
+            }
+            --_index;
+            return *this;
+        }
+        const T& operator*() const { return _block->data()[_index]; }
+        bool operator==(const const_iterator& rhs) const { return _block == rhs._block && _index == rhs._index; }
+        bool operator!=(const const_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    IndexedList() {}
+    IndexedList(const std::initializer_list<T> il) {
+        for (const T& i : il) pushr(i);
+    }
+    IndexedList(const IndexedList& list) {
+        for (const T& i : list) pushr(i);
+    }
+    IndexedList(const std::vector<T>& list) {
+        for (const T& i : list) pushr(i);
+    }
+    IndexedList(const T* list, size_t length) {
+        for (size_t i = 0; i < length; ++i) pushr(list[i]);
+    }
+    IndexedList(std::function<T(size_t)> fn, size_t length) {
+        for (size_t i = 0; i < length; ++i) pushr(fn(i));
+    }
+    IndexedList& operator=(const IndexedList& rhs) {
+        if (this != &rhs) {
+            clear();
+            for (const T& i : rhs) pushr(i);
+        }
+        return *this;
+    }
+    ~IndexedList() {
+        clear();
+        free_block(_head);
+    }
+
+    std::string string() const {
+        return (std::ostringstream() << *this).str();
+    }
+
+    size_t length() const { return _length; }
+    size_t size() const { return _length; }
+    bool is_empty() const { return _length == 0; }
+    size_t block_count() const {
+        size_t ret = 0;
+        for (Block* b = _head->link(0).next; b; b = b->link(0).next) ++ret;
+        return ret;
+    }
+    void clear() {
+        for (Block* b = _head->link(0).next; b;) {
+            Block* next = b->link(0).next;
+            std::destroy(b->data(), b->data() + b->count);
+            free_block(b);
+            b = next;
+        }
+        for (size_t i = 0; i < _levels; ++i) _head->link(i) = {nullptr, 0};
+        _levels = 1;
+        _length = 0;
+        _back = nullptr;
+    }
+
+    iterator begin() { return iterator(_head->link(0).next); }
+    const_iterator begin() const { return const_iterator(_head->link(0).next); }
+    iterator end() { return iterator(); }
+    const_iterator end() const { return const_iterator(); }
+    iterator back() { return _back ? iterator(_back, _back->count - 1) : end(); }
+    const_iterator back() const { return _back ? const_iterator(_back, _back->count - 1) : end(); }
+
+    T& operator[](int index) {
+        if (index < 0) index += _length;
+        if (index < 0 || size_t(index) >= _length) throw ListOutOfBounds();
+        size_t pos = index;
+        auto [b, at] = locate(pos);
+        return b->data()[at];
+    }
+    void insert(int index, const T val) {
+        if (index < 0) index += _length + 1;
+        if (index < 0 || size_t(index) > _length) throw ListOutOfBounds();
+        size_t pos = index;
+        Block* pred[MAX_LEVEL];
+        size_t rank[MAX_LEVEL];
+        before(pos + 1, pred, rank);
+        Block* b = pred[0];
+        size_t at = pos - rank[0];
+        Block* n = nullptr;
+        if (b == _head || b->count == CAPACITY) {
+            // Appending starts a new block and prepending empties the first one, so pushr and pushl leave full
+            // blocks behind; anywhere else the block splits in half.
+            size_t count = b->count;
+            size_t k = at == count ? count : pos == 0 ? 0 : count / 2;
+            n = split(b, k, pred, rank);
+            if (at > k || (at == k && k == count)) {
+                b = n;
+                at -= k;
+            }
+        }
+        insert_at(b, at, val);
+        for (size_t i = 0; i < _levels; ++i) {
+            ++(b == n && i < n->height ? n->link(i) : pred[i]->link(i)).width;
+        }
+        ++_length;
+    }
+    void del(int index) {
+        if (index < 0) index += _length;
+        if (index < 0 || size_t(index) >= _length) throw ListOutOfBounds();
+        size_t pos = index;
+        Block* pred[MAX_LEVEL];
+        size_t rank[MAX_LEVEL];
+        before(pos + 1, pred, rank);
+        Block* b = pred[0];
+        T* d = b->data();
+        std::move(d + (pos - rank[0]) + 1, d + b->count, d + (pos - rank[0]));
+        std::destroy_at(d + b->count - 1);
+        --b->count;
+        for (size_t i = 0; i < _levels; ++i) --pred[i]->link(i).width;
+        --_length;
+        if (b->count == 0) {
+            unlink(b, rank[0]);
+        } else if (b->count < CAPACITY / 2) {
+            Block* next = b->link(0).next;
+            if (next && b->count + next->count <= CAPACITY) absorb(b, rank[0]);
+            else if (b->prev && b->prev->count + b->count <= CAPACITY) absorb(b->prev, rank[0] - b->prev->count);
+        }
+    }
+    std::vector<size_t> find_vals(const T val) const {
+        std::vector<size_t> ret;
+        size_t index = 0;
+        for (const Block* b = _head->link(0).next; b; b = b->link(0).next) {
+            const T* d = b->data();
+            for (uint32_t i = 0; i < b->count; ++i, ++index) {
+                if (d[i] == val) ret.push_back(index);
+            }
+        }
+        return ret;
+    }
+    void del_vals(const T val) {
+        for (Block* b = _head->link(0).next; b; b = b->link(0).next) {
+            T* d = b->data();
+            T* kept = std::remove(d, d + b->count, val);
+            std::destroy(kept, d + b->count);
+            _length -= d + b->count - kept;
+            b->count = kept - d;
+        }
+        reindex();
+    }
+
+    void pushl(const T val) { insert(0, val); }
+    void pushr(const T val) { insert(-1, val); }
+    void popl() { del(0); }
+    void popr() { del(-1); }
+
+    bool operator==(const IndexedList& rhs) const {
+        if (_length != rhs._length) return false;
+        for (auto l = begin(), r = rhs.begin(); l != end(); ++l, ++r) {
+            if (*l != *r) return false;
+        }
+        return true;
+    }
+    bool operator!=(const IndexedList& rhs) const { return !(*this == rhs); }
+    template <typename Fn>
+    T reduce(Fn&& fn, T start = T()) const {
+        for (const Block* b = _head->link(0).next; b; b = b->link(0).next) {
+            const T* d = b->data();
+            for (uint32_t i = 0; i < b->count; ++i) start = fn(std::move(start), d[i]);
+        }
+        return start;
+    }
+    template <typename Fn>
+    void apply(Fn&& fn) {
+        for (Block* b = _head->link(0).next; b; b = b->link(0).next) {
+            T* d = b->data();
+            for (uint32_t i = 0; i < b->count; ++i) d[i] = fn(std::move(d[i]));
+        }
+    }
+};
+
+template <typename T, size_t BlockBytes>
+std::ostream& operator<<(std::ostream& os, const IndexedList<T, BlockBytes>& rhs) {
+    os << "{";
+    if (!rhs.is_empty()) {
+        for (auto i = rhs.begin(); i != rhs.back(); ++i) {
+            os << *i << ", ";
+        }
+        os << *rhs.back();
+    }
+    os << "}";
+    return os;
+}
+
+#endif // INDEXED_LIST_HPP
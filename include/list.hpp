@@ -2,6 +2,8 @@
 #define LIST_HPP
 
 #include "list_node.hpp"
+#include "node_pool.hpp"
+#include "parallel.hpp"
 
 #include <iostream>
 #include <cstddef>
@@ -10,17 +12,140 @@
 #include <functional>
 #include <string>
 #include <initializer_list>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
 class ListOutOfBounds : public std::range_error {
 public:
     explicit ListOutOfBounds() : std::range_error("List index out of bounds") {}
 };
 
-template <typename T>
+// Nodes come from Pool (see node_pool.hpp). By default each list gets its own NodePool, so its nodes are packed
+// into a few slabs and clear() hands the slabs back whole; pass a pool to the constructor to share one.
+template <typename T, typename Pool = NodePool<ListNode<T>>>
 class List {
+public:
+    static constexpr size_t RUNS_PER_THREAD = 4; // runs the parallel overloads cut per pool thread, for balance
+
+private:
     size_t _length;
     ListNode<T>* _begin;
     ListNode<T>* _back;
+    Pool _pool;
+
+    template <typename... Args>
+    ListNode<T>* make_node(Args&&... args) {
+        ListNode<T>* node = _pool.allocate();
+        try {
+            return new (node) ListNode<T>(std::in_place, std::forward<Args>(args)...);
+        } catch (...) {
+            _pool.deallocate(node);
+            throw;
+        }
+    }
+    void destroy(ListNode<T>* node) { // also unlinks it from its neighbours
+        node->~ListNode();
+        _pool.deallocate(node);
+    }
+
+    ListNode<T>* node_at(size_t pos) const { // pos < _length; walks from the nearer end
+        ListNode<T>* p;
+        if (pos < _length / 2) {
+            p = _begin;
+            for (size_t _ = 0; _ < pos; ++_) p = p->next();
+        } else {
+            p = _back;
+            for (size_t _ = 0; _ < _length - pos - 1; ++_) p = p->prev();
+        }
+        return p;
+    }
+
+    // Moves the count nodes first..last (inclusive) out of other and in front of pos, or to the back if pos is
+    // null. Only pointers change, unless the nodes are some but not all of a list with another pool: adopting
+    // that pool would keep all its slabs alive for the sake of a few nodes, so the elements are moved into new
+    // nodes from this list's pool instead.
+    void transfer(ListNode<T>* pos, List& other, ListNode<T>* first, ListNode<T>* last, size_t count) {
+        if (count == 0) return;
+        if (&other != this && !(_pool == other._pool)) {
+            if (count < other._length) {
+                rehome(pos, other, first, count);
+                return;
+            }
+            _pool.adopt(other._pool); // the nodes must stay valid after other is gone
+        }
+        ListNode<T>* before = first->_prev;
+        ListNode<T>* after = last->_next;
+        (before ? before->_next : other._begin) = after;
+        (after ? after->_prev : other._back) = before;
+        other._length -= count;
+        ListNode<T>* prev = pos ? pos->_prev : _back;
+        first->_prev = prev;
+        last->_next = pos;
+        (prev ? prev->_next : _begin) = first;
+        (pos ? pos->_prev : _back) = last;
+        _length += count;
+    }
+    void rehome(ListNode<T>* pos, List& other, ListNode<T>* first, size_t count) { // one node at a time
+        for (ListNode<T>* p = first; count-- > 0;) {
+            ListNode<T>* node = make_node(std::move(p->val));
+            ListNode<T>* prev = pos ? pos->_prev : _back;
+            node->_prev = prev;
+            node->_next = pos;
+            (prev ? prev->_next : _begin) = node;
+            (pos ? pos->_prev : _back) = node;
+            ++_length;
+            ListNode<T>* next = p->_next;
+            if (p == other._begin) other._begin = next;
+            if (p == other._back) other._back = p->_prev;
+            other.destroy(p);
+            --other._length;
+            p = next;
+        }
+    }
+
+    // Merges two null-terminated chains sorted by cmp, following _next only; a's nodes win ties.
+    template <typename Compare>
+    static ListNode<T>* merge_chains(ListNode<T>* a, ListNode<T>* b, Compare& cmp) {
+        ListNode<T>* head = nullptr;
+        ListNode<T>** tail = &head;
+        while (a && b) {
+            if (cmp(b->val, a->val)) {
+                *tail = b;
+                b = b->_next;
+            } else {
+                *tail = a;
+                a = a->_next;
+            }
+            tail = &(*tail)->_next;
+        }
+        *tail = a ? a : b;
+        return head;
+    }
+    void adopt_chain(ListNode<T>* head) { // takes head's chain as the whole list, fixing the _prev links
+        _begin = head;
+        _back = nullptr;
+        for (auto* p = head; p; p = p->_next) {
+            p->_prev = _back;
+            _back = p;
+        }
+    }
+
+    // Cuts the list into up to `pieces` runs of nearly equal length in one walk. Run i starts at node
+    // runs[i].first, at index runs[i].second, and ends where run i + 1 starts; the last entry is the end.
+    std::vector<std::pair<ListNode<T>*, size_t>> runs(size_t pieces) const {
+        pieces = std::max<size_t>(1, std::min(pieces, _length));
+        std::vector<std::pair<ListNode<T>*, size_t>> ret;
+        ret.reserve(pieces + 1);
+        ListNode<T>* p = _begin;
+        size_t at = 0;
+        for (size_t i = 0; i < pieces; ++i) {
+            ret.emplace_back(p, at);
+            for (size_t next = (i + 1) * _length / pieces; at < next; ++at) p = p->next();
+        }
+        ret.emplace_back(nullptr, _length);
+        return ret;
+    }
 
 public:
 
@@ -31,12 +156,13 @@ public:
         iterator(ListNode<T>* node) : _node(node) {}
         iterator& operator++() { _node = _node->next(); return *this; }
         iterator& operator--() { _node = _node->prev(); return *this; }
-        T operator*() const { return _node->val; }
+        T& operator*() const { return _node->val; }
+        T* operator->() const { return &_node->val; }
         ListNode<T>* node() const { return _node; }
-        bool operator==(const typename List<T>::iterator& rhs) {
+        bool operator==(const iterator& rhs) const {
             return _node == rhs._node;
         }
-        bool operator!=(const typename List<T>::iterator& rhs) {
+        bool operator!=(const iterator& rhs) const {
             return _node != rhs._node;
         }
     };
@@ -48,32 +174,45 @@ public:
         const_iterator(ListNode<T>* node) : _node(node) {}
         const_iterator& operator++() { _node = _node->next(); return *this; }
         const_iterator& operator--() { _node = _node->prev(); return *this; }
-        T operator*() const { return _node->val; }
+        const T& operator*() const { return _node->val; }
+        const T* operator->() const { return &_node->val; }
         const ListNode<T>* node() const { return _node; }
-        bool operator==(const typename List<T>::const_iterator& rhs) {
+        bool operator==(const const_iterator& rhs) const {
             return _node == rhs._node;
         }
-        bool operator!=(const typename List<T>::const_iterator& rhs) {
+        bool operator!=(const const_iterator& rhs) const {
             return _node != rhs._node;
         }
     };
 
     List() : _length(0), _begin(nullptr), _back(nullptr) {}
+    explicit List(const Pool& pool) : _length(0), _begin(nullptr), _back(nullptr), _pool(pool) {}
     List(const std::initializer_list<T> il): _length(0), _begin(nullptr), _back(nullptr) {
-        for (T i : il) {
+        for (const T& i : il) {
             pushr(i);
         }
     }
-    List(const List<T>& list) : _length(0), _begin(nullptr), _back(nullptr) {
-        for (auto it : list) {
+    List(const List& list) : _length(0), _begin(nullptr), _back(nullptr) {
+        for (const T& it : list) {
             pushr(it);
         }
     }
-    List(const std::vector<T> list) : _length(0), _begin(nullptr), _back(nullptr) {
-        for (auto it : list) {
+    // Takes over the nodes and the pool; list is left empty, with a pool of its own.
+    List(List&& list)
+        : _length(std::exchange(list._length, 0)), _begin(std::exchange(list._begin, nullptr)),
+          _back(std::exchange(list._back, nullptr)), _pool(std::exchange(list._pool, Pool())) {}
+    List(const std::vector<T>& list) : _length(0), _begin(nullptr), _back(nullptr) {
+        for (const T& it : list) {
             pushr(it);
         }
     }
+    // A vector's buffer can't become list nodes, so this moves the elements out of it instead of copying.
+    List(std::vector<T>&& list) : _length(0), _begin(nullptr), _back(nullptr) {
+        for (T& it : list) {
+            pushr(std::move(it));
+        }
+        list.clear();
+    }
     List(const T* list, size_t length) : _length(0), _begin(nullptr), _back(nullptr) {
         for (size_t i = 0; i < length; ++i) {
             pushr(list[i]);
@@ -86,7 +225,15 @@ public:
     }
     ~List() { clear(); }
 
-    std::string string() {
+    List& operator=(List rhs) noexcept { // copies or moves into rhs first, then swaps
+        std::swap(_length, rhs._length);
+        std::swap(_begin, rhs._begin);
+        std::swap(_back, rhs._back);
+        std::swap(_pool, rhs._pool);
+        return *this;
+    }
+
+    std::string string() const {
         return (std::ostringstream() << *this).str();
     }
     
@@ -94,16 +241,21 @@ public:
     size_t size() const { return _length; }
     bool is_empty() const { return _length == 0; }
     void clear() {
-        for (auto* p = _begin; p != nullptr;) {
-            auto* p_next = p->next();
-            delete p;
-            p = p_next;
+        if (!std::is_trivially_destructible_v<T> || !_pool.release()) {
+            for (auto* p = _begin; p != nullptr;) {
+                auto* p_next = p->next();
+                destroy(p);
+                p = p_next;
+            }
+            _pool.release();
         }
         _length = 0;
         _begin = nullptr;
         _back = nullptr;
     }
 
+    Pool pool() const { return _pool; }
+
     iterator begin() { return iterator(_begin); }
     const_iterator begin() const { return const_iterator(_begin); }
     iterator end() { return nullptr; }
@@ -114,21 +266,14 @@ public:
     T& operator[](int pos) {
         if (pos < 0) pos += _length;
         if (!(0 <= pos && pos < _length)) throw ListOutOfBounds();
-        if (pos < _length / 2) {
-            auto it = begin();
-            for (size_t _ = 0; _ < pos; ++_) ++it;
-            return it.node()->val;
-        } else {
-            auto it = back();
-            for (size_t _ = 0; _ < _length - pos - 1; ++_) --it;
-            return it.node()->val;
-        }
+        return node_at(pos)->val;
     }
-    void insert(int pos, const T val) {
+    template <typename... Args>
+    T& emplace(int pos, Args&&... args) { // constructs the element in its node from args
         if (pos < 0) pos += _length + 1;
         if (!(0 <= pos && pos <= _length)) throw ListOutOfBounds();
         
-        ListNode<T>* inserted = new ListNode<T>(val);
+        ListNode<T>* inserted = make_node(std::forward<Args>(args)...);
         if (_length == 0) {
             _begin = _back = inserted;
             goto end;
@@ -155,18 +300,26 @@ public:
         }
         end:
         ++_length;
+        return inserted->val;
     }
+    void insert(int pos, const T& val) { emplace(pos, val); }
+    void insert(int pos, T&& val) { emplace(pos, std::move(val)); }
     void del(int pos) { 
         if (pos < 0) pos += _length;
         if (!(0 <= pos && pos < _length)) throw ListOutOfBounds();
     
+        if (_length == 1) {
+            destroy(_begin);
+            _begin = _back = nullptr;
+            goto end;
+        }
         if (pos == 0) {
             _begin = _begin->next();
-            delete _begin->prev();
+            destroy(_begin->prev());
             goto end;
         } if (pos == _length - 1) {
             _back = _back->prev();
-            delete _back->next();
+            destroy(_back->next());
             goto end;
         }
     
@@ -175,21 +328,21 @@ public:
             for (size_t _ = 0; _ < pos; ++_) {
                 ++it;
             }
-            delete it.node();
+            destroy(it.node());
         } else {
             auto it = back();
             for (size_t _ = 0; _ < _length - pos - 1; ++_) {
                 --it;
             }
-            delete it.node();
+            destroy(it.node());
         }
         end:
         --_length;
     }
-    std::vector<size_t> find_vals(const T val) {
+    std::vector<size_t> find_vals(const T& val) const {
         std::vector<size_t> its;
         size_t index = 0;
-        for (auto it : *this) {
+        for (const T& it : *this) {
             if (it == val) {
                 its.push_back(index);
             }
@@ -197,40 +350,99 @@ public:
         }
         return its;
     }
-    void del_vals(const T val) {
-        if (is_empty()) return;
-        while (_begin->val == val && _begin != _back) {
-            _begin = _begin->next();
-            delete _begin->prev();
-            --_length;
-        }
-        while (_back->val == val && _begin != _back) {
-            _back = _back->prev();
-            delete _back->next();
+    void del_vals(const T& val) {
+        ListNode<T>* holder = nullptr; // the node val lives in, if it is one of ours; deleted last
+        auto unlink = [&](ListNode<T>* p) {
+            if (p == _begin) _begin = p->next();
+            if (p == _back) _back = p->prev();
+            destroy(p);
             --_length;
+        };
+        for (auto* p = _begin; p != nullptr;) {
+            auto* p_next = p->next();
+            if (&p->val == &val) holder = p;
+            else if (p->val == val) unlink(p);
+            p = p_next;
         }
-        if (_begin == _back) {
-            if (_begin->val == val) {
-                delete _begin;
-                _begin = _back = nullptr;
-                _length = 0;
-            }
-            return;
+        if (holder) unlink(holder);
+    }
+    
+    // Splicing moves nodes between lists, or within one, by relinking them: nothing is copied or allocated. Taking
+    // all of a list with another pool makes this list's pool adopt its slabs (see NodePool::adopt) so the nodes
+    // outlive it. Taking only part of such a list moves each element into a new node instead, which is O(count)
+    // and invalidates iterators to the moved elements; lists built on one shared pool (List(pool)) always relink.
+    // Nodes go in front of pos; end() appends.
+    void splice(iterator pos, List& other) { // all of other; O(1)
+        transfer(pos.node(), other, other._begin, other._back, other._length);
+    }
+    void splice(iterator pos, List& other, iterator it) { // one node; O(1) when relinked
+        transfer(pos.node(), other, it.node(), it.node(), 1);
+    }
+    // [first, last) of other, which must not contain pos. O(1) when the pools match and the range's length is
+    // passed in, otherwise the range is counted first.
+    void splice(iterator pos, List& other, iterator first, iterator last, size_t count) {
+        if (count > 0) transfer(pos.node(), other, first.node(), last.node() ? last.node()->prev() : other._back, count);
+    }
+    void splice(iterator pos, List& other, iterator first, iterator last) {
+        size_t count = 0;
+        for (auto it = first; it != last; ++it) ++count;
+        splice(pos, other, first, last, count);
+    }
+    void concat(List& other) { splice(end(), other); }
+    void concat(List&& other) { splice(end(), other); }
+    // Moves [pos, end) into a new list sharing this list's pool; pos may be negative, as in insert().
+    // Walks to pos from the nearer end; the move itself is O(1).
+    List split_at(int pos) {
+        if (pos < 0) pos += _length + 1;
+        if (pos < 0 || size_t(pos) > _length) throw ListOutOfBounds();
+        size_t at = pos;
+        List tail(_pool);
+        if (at < _length) tail.transfer(nullptr, *this, node_at(at), _back, _length - at);
+        return tail;
+    }
+
+    // Merges sorted other into this sorted list in one pass, leaving other empty. Stable: on ties, this list's
+    // elements come first.
+    template <typename Compare = std::less<>>
+    void merge(List& other, Compare cmp = Compare()) {
+        if (&other == this) return;
+        _pool.adopt(other._pool);
+        _length += std::exchange(other._length, 0);
+        adopt_chain(merge_chains(_begin, std::exchange(other._begin, nullptr), cmp));
+        other._back = nullptr;
+    }
+    // Stable merge sort on the node chain: O(n log n) comparisons, no allocation, and elements never move.
+    // Sorted runs of length 2^i wait in bin i, as in a binary counter; each node carries into the bins.
+    template <typename Compare = std::less<>>
+    void sort(Compare cmp = Compare()) {
+        ListNode<T>* bins[64] = {};
+        for (auto* p = _begin; p;) {
+            ListNode<T>* carry = p;
+            p = p->_next;
+            carry->_next = nullptr;
+            size_t i = 0;
+            for (; bins[i]; ++i) carry = merge_chains(std::exchange(bins[i], nullptr), carry, cmp);
+            bins[i] = carry;
         }
-        for (auto i = begin(); i != back(); ++i) {
-            for (;*i == val; ++i) {
-                delete i.node();
-                --_length;
-            }
+        ListNode<T>* sorted = nullptr;
+        for (auto* bin : bins) { // higher bins hold earlier elements
+            if (bin) sorted = merge_chains(bin, sorted, cmp);
         }
+        adopt_chain(sorted);
     }
-    
-    void pushl(const T val) { insert(0, val); }
-    void pushr(const T val) { insert(-1, val); }
+
+    void pushl(const T& val) { emplace(0, val); }
+    void pushl(T&& val) { emplace(0, std::move(val)); }
+    void pushr(const T& val) { emplace(-1, val); }
+    void pushr(T&& val) { emplace(-1, std::move(val)); }
+    template <typename... Args>
+    T& emplacel(Args&&... args) { return emplace(0, std::forward<Args>(args)...); }
+    template <typename... Args>
+    T& emplacer(Args&&... args) { return emplace(-1, std::forward<Args>(args)...); }
     void popl() { del(0); }
     void popr() { del(-1); }
     
-    bool operator==(const List<T> rhs) {
+    bool operator==(const List& rhs) const {
         if (_length != rhs._length) return false;
         auto l = begin(), r = rhs.begin();
         while (l != nullptr && r != nullptr) {
@@ -239,7 +451,7 @@ public:
         }
         return true;
     }
-    bool operator!=(const List<T> rhs) {
+    bool operator!=(const List& rhs) const {
         if (_length != rhs._length) return true;
         auto l = begin(), r = rhs.begin();
         while (l != nullptr && r != nullptr) {
@@ -248,21 +460,63 @@ public:
         }
         return false;
     }
-    T reduce(const std::function<T(T, T)> fn, T start = T()) {
-        for (auto i : *this) {
-            start = fn(start, i);
+    template <typename Fn>
+    T reduce(Fn&& fn, T start = T()) const {
+        for (const T& i : *this) {
+            start = fn(std::move(start), i);
         }
         return start;
     }
-    void apply(const std::function<T(T)> fn) {
+    template <typename Fn>
+    void apply(Fn&& fn) {
         for (auto i = begin(); i != nullptr; ++i) {
-            i.node()->val = fn(i.node()->val);
+            *i = fn(std::move(*i));
         }
     }
+
+    // Parallel versions: one walk cuts the list into runs, then the pool's threads take the runs. The walk is as
+    // long as a sequential pass, so these pay off when fn costs more than following a pointer.
+    //
+    // reduce() folds each run on its own, starting from the run's first element, then folds start with the run
+    // results left to right. That equals the sequential fold whenever fn is associative; fn need not be
+    // commutative, and start is used exactly once.
+    template <typename Fn>
+    T reduce(Fn&& fn, T start, parallel::ThreadPool& pool) const {
+        if (is_empty()) return start;
+        auto cuts = runs(pool.size() * RUNS_PER_THREAD);
+        std::vector<std::optional<T>> folded(cuts.size() - 1);
+        parallel::for_each(0, folded.size(), [&](size_t r) {
+            T acc = cuts[r].first->val;
+            for (auto* p = cuts[r].first->next(); p != cuts[r + 1].first; p = p->next()) acc = fn(std::move(acc), p->val);
+            folded[r] = std::move(acc);
+        }, pool, 1);
+        for (auto& acc : folded) start = fn(std::move(start), std::move(*acc));
+        return start;
+    }
+    template <typename Fn>
+    void apply(Fn&& fn, parallel::ThreadPool& pool) {
+        auto cuts = runs(pool.size() * RUNS_PER_THREAD);
+        parallel::for_each(0, cuts.size() - 1, [&](size_t r) {
+            for (auto* p = cuts[r].first; p != cuts[r + 1].first; p = p->next()) p->val = fn(std::move(p->val));
+        }, pool, 1);
+    }
+    std::vector<size_t> find_vals(const T& val, parallel::ThreadPool& pool) const {
+        auto cuts = runs(pool.size() * RUNS_PER_THREAD);
+        std::vector<std::vector<size_t>> found(cuts.size() - 1);
+        parallel::for_each(0, found.size(), [&](size_t r) {
+            size_t index = cuts[r].second;
+            for (auto* p = cuts[r].first; p != cuts[r + 1].first; p = p->next(), ++index) {
+                if (p->val == val) found[r].push_back(index);
+            }
+        }, pool, 1);
+        std::vector<size_t> its;
+        for (auto& run : found) its.insert(its.end(), run.begin(), run.end());
+        return its;
+    }
 };
 
-template <typename T>
-std::ostream& operator<<(std::ostream& os, const List<T>& rhs) {
+template <typename T, typename Pool>
+std::ostream& operator<<(std::ostream& os, const List<T, Pool>& rhs) {
     os << "{";
     if (!rhs.is_empty()) {
         for (auto i = rhs.begin(); i != rhs.back(); ++i) {
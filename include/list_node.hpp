@@ -1,14 +1,23 @@
 #ifndef LIST_NODE_HPP
 #define LIST_NODE_HPP
 
+#include <utility>
+
+template <typename T, typename Pool>
+class List;
+
 template<typename T>
 class ListNode {
+    template <typename, typename> friend class List; // relinks whole runs of nodes directly
     ListNode<T>* _next;
     ListNode<T>* _prev;
 public:
     T val;
     
-    ListNode(T val) : val(val), _prev(nullptr), _next(nullptr) {}
+    template <typename... Args>
+    explicit ListNode(std::in_place_t, Args&&... args) : _next(nullptr), _prev(nullptr), val(std::forward<Args>(args)...) {}
+    ListNode(const T& val) : ListNode(std::in_place, val) {}
+    ListNode(T&& val) : ListNode(std::in_place, std::move(val)) {}
     ListNode(const ListNode<T>& node) { *this = ListNode(node.val); }
     ~ListNode() {
         if (_prev) _prev->_next = _next;
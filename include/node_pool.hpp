@@ -0,0 +1,138 @@
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Node allocators for List. Both hand out raw storage for one node at a time; the list constructs and destroys
+// the node in it.
+//
+// NodePool carves nodes out of slabs that double in size up to SLAB_BYTES, so allocating is a free-list pop or a
+// pointer bump and nodes allocated one after another sit next to each other in memory. Freed nodes go on the
+// free list for reuse. release() drops every slab at once, which a list does in clear() when nothing else shares
+// its pool. Copies of a NodePool share the same slabs; a default-constructed one starts empty.
+//
+// adopt() lets nodes move between lists with different pools: the two pools' slabs are pooled into one arena
+// that both (and every copy of either) then allocate from, so a node is valid wherever it ends up. The
+// absorbed arena forwards to the surviving one, and handles follow the forwarding lazily. Merging is for good,
+// so List only does it when it takes over all of another list's nodes.
+template <typename Node>
+class NodePool {
+public:
+    static constexpr size_t FIRST_SLAB = 16; // nodes
+    static constexpr size_t SLAB_BYTES = 1 << 20;
+
+private:
+    union Slot {
+        Slot* next_free;
+        alignas(Node) std::byte storage[sizeof(Node)];
+    };
+
+    struct Arena {
+        std::vector<std::unique_ptr<Slot[]>> slabs;
+        size_t next_slab = FIRST_SLAB;
+        Slot* bump = nullptr;
+        Slot* bump_end = nullptr;
+        Slot* free = nullptr;
+        Slot* free_tail = nullptr; // so adopt() can chain free lists without walking them
+        std::vector<std::pair<Slot*, Slot*>> spare; // unused slab tails left over from adopt()
+        std::shared_ptr<Arena> merged_into; // set once this arena's slabs have moved there
+
+        Slot* grow() { // the bump range is used up
+            if (!spare.empty()) {
+                std::tie(bump, bump_end) = spare.back();
+                spare.pop_back();
+                return bump++;
+            }
+            slabs.push_back(std::make_unique_for_overwrite<Slot[]>(next_slab));
+            bump = slabs.back().get();
+            bump_end = bump + next_slab;
+            next_slab = std::min(next_slab * 2, std::max<size_t>(FIRST_SLAB, SLAB_BYTES / sizeof(Slot)));
+            return bump++;
+        }
+    };
+
+    mutable std::shared_ptr<Arena> _arena = std::make_shared<Arena>();
+
+    Arena& arena() const {
+        while (_arena->merged_into) _arena = _arena->merged_into;
+        return *_arena;
+    }
+
+public:
+    Node* allocate() {
+        Arena& a = arena();
+        Slot* slot;
+        if (a.free) {
+            slot = a.free;
+            a.free = slot->next_free;
+            if (!a.free) a.free_tail = nullptr;
+        } else if (a.bump != a.bump_end) {
+            slot = a.bump++;
+        } else {
+            slot = a.grow();
+        }
+        return reinterpret_cast<Node*>(slot->storage);
+    }
+    void deallocate(Node* node) {
+        Arena& a = arena();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next_free = a.free;
+        a.free = slot;
+        if (!a.free_tail) a.free_tail = slot;
+    }
+    // Merges other's arena into this one; afterwards both pools, and all copies of either, share the slabs.
+    // Takes time in the number of slabs, which grows logarithmically with the nodes allocated.
+    void adopt(NodePool& other) {
+        Arena& a = arena();
+        Arena& b = other.arena();
+        if (&a == &b) return;
+        std::move(b.slabs.begin(), b.slabs.end(), std::back_inserter(a.slabs));
+        if (b.free) {
+            b.free_tail->next_free = a.free;
+            a.free = b.free;
+            if (!a.free_tail) a.free_tail = b.free_tail;
+        }
+        if (b.bump_end - b.bump > a.bump_end - a.bump) { // bump from the larger unused tail, keep the other
+            std::swap(a.bump, b.bump);
+            std::swap(a.bump_end, b.bump_end);
+        }
+        if (b.bump != b.bump_end) a.spare.emplace_back(b.bump, b.bump_end);
+        a.spare.insert(a.spare.end(), b.spare.begin(), b.spare.end());
+        a.next_slab = std::max(a.next_slab, b.next_slab);
+        b = Arena();
+        b.merged_into = _arena;
+        other._arena = _arena;
+    }
+    // Frees all slabs if this is the only handle to them, and says whether it did. Every node the pool handed out
+    // must already be destroyed (their memory goes with the slabs).
+    bool release() {
+        arena();
+        if (_arena.use_count() != 1) return false;
+        *_arena = Arena();
+        return true;
+    }
+    size_t slab_count() const { return arena().slabs.size(); }
+
+    bool operator==(const NodePool& rhs) const { return &arena() == &rhs.arena(); }
+};
+
+// Plain operator new and delete per node: what List did before it had pools.
+template <typename Node>
+class HeapNodes {
+public:
+    Node* allocate() { return static_cast<Node*>(::operator new(sizeof(Node), std::align_val_t(alignof(Node)))); }
+    void deallocate(Node* node) { ::operator delete(node, std::align_val_t(alignof(Node))); }
+    bool release() { return false; }
+    void adopt(HeapNodes&) {}
+
+    bool operator==(const HeapNodes&) const { return true; }
+};
+
+#endif // NODE_POOL_HPP
@@ -0,0 +1,132 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Fork-join pool: run(job) calls job(t) once for every thread index t in [0, size()) and blocks until all of
+// them return. The calling thread takes t = 0, so a pool of size 1 has no worker threads at all.
+class ThreadPool {
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::mutex _run_mutex; // serializes concurrent run() calls
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(size_t)>* _job = nullptr;
+    size_t _generation = 0;
+    size_t _pending = 0;
+    bool _stop = false;
+    std::exception_ptr _error;
+
+    void work(size_t index) {
+        size_t seen = 0;
+        while (true) {
+            const std::function<void(size_t)>* job;
+            {
+                std::unique_lock lock(_mutex);
+                _wake.wait(lock, [&] { return _stop || _generation != seen; });
+                if (_stop) return;
+                seen = _generation;
+                job = _job;
+            }
+            try {
+                (*job)(index);
+            } catch (...) {
+                std::lock_guard lock(_mutex);
+                if (!_error) _error = std::current_exception();
+            }
+            std::lock_guard lock(_mutex);
+            if (--_pending == 0) _done.notify_one();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads = 0) { // 0 means one per hardware thread
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 1; i < threads; ++i) _workers.emplace_back(&ThreadPool::work, this, i);
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto& worker : _workers) worker.join();
+    }
+
+    size_t size() const { return _workers.size() + 1; }
+
+    // Rethrows the first exception thrown by any job. Jobs must not call run() on the same pool.
+    void run(const std::function<void(size_t)>& job) {
+        std::lock_guard serial(_run_mutex);
+        if (_workers.empty()) {
+            job(0);
+            return;
+        }
+        {
+            std::lock_guard lock(_mutex);
+            _job = &job;
+            _pending = _workers.size();
+            _error = nullptr;
+            ++_generation;
+        }
+        _wake.notify_all();
+        std::exception_ptr error;
+        try {
+            job(0);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::unique_lock lock(_mutex);
+            _done.wait(lock, [&] { return _pending == 0; });
+            if (!error) error = _error;
+        }
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+inline ThreadPool& default_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Calls fn(t, first, last) on consecutive chunks [first, last) of at most grain indices covering [begin, end),
+// handing chunks to threads as they free up. t is the pool thread running the chunk, for per-thread buffers.
+template <typename Fn>
+void for_chunks(size_t begin, size_t end, Fn&& fn, ThreadPool& pool = default_pool(), size_t grain = 1024) {
+    if (end <= begin) return;
+    if (pool.size() == 1 || end - begin <= grain) {
+        for (size_t first = begin; first < end; first += grain) fn(size_t(0), first, std::min(first + grain, end));
+        return;
+    }
+    std::atomic<size_t> next = begin;
+    pool.run([&](size_t t) {
+        for (size_t first; (first = next.fetch_add(grain, std::memory_order_relaxed)) < end;) {
+            fn(t, first, std::min(first + grain, end));
+        }
+    });
+}
+
+// Calls fn(i) for every i in [begin, end).
+template <typename Fn>
+void for_each(size_t begin, size_t end, Fn&& fn, ThreadPool& pool = default_pool(), size_t grain = 1024) {
+    for_chunks(begin, end, [&](size_t, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) fn(i);
+    }, pool, grain);
+}
+
+}
+
+#endif // PARALLEL_HPP
@@ -1,133 +1,539 @@
 #ifndef SORT_HPP
 #define SORT_HPP
 
-#include <vector>
-#include <iostream>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-void countingSort(std::vector<int>& arr, int exp) { // For RADIX ---------------------
-    int n = arr.size();
-    std::vector<int> output(n);
-    int count[10] = {0};
+// Each sort takes an iterator pair or a random-access range, then an optional comparator and projection as in
+// std::ranges: elements are ordered by cmp(proj(a), proj(b)). radix() has no comparator; it orders by the
+// numeric key proj returns. Positions are size_t throughout, so arrays past 2^31 elements are fine.
 
-    for (int i = 0; i < n; i++)
-        count[(arr[i] / exp) % 10]++;
+namespace sort_detail {
 
-    for (int i = 1; i < 10; i++)
-        count[i] += count[i - 1];
+template <typename Compare, typename Proj>
+struct Less { // cmp(proj(a), proj(b)) as one callable
+    Compare& cmp;
+    Proj& proj;
 
-    for (int i = n - 1; i >= 0; i--) {
-        output[count[(arr[i] / exp) % 10] - 1] = arr[i];
-        count[(arr[i] / exp) % 10]--;
+    template <typename A, typename B>
+    bool operator()(A&& a, B&& b) const {
+        return std::invoke(cmp, std::invoke(proj, std::forward<A>(a)), std::invoke(proj, std::forward<B>(b)));
     }
+};
 
-    for (int i = 0; i < n; i++)
-        arr[i] = output[i];
+template <typename It, typename Less>
+void insertion(It first, It last, Less& less) {
+    size_t n = last - first;
+    for (size_t i = 1; i < n; ++i) {
+        if (!less(first[i], first[i - 1])) continue;
+        auto key = std::move(first[i]);
+        size_t j = i;
+        for (; j > 0 && less(key, first[j - 1]); --j) first[j] = std::move(first[j - 1]);
+        first[j] = std::move(key);
+    }
 }
-int partition(std::vector<int>& arr, int low, int high) { // For QUICK ---------------
-    int pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; j++) {
-        if (arr[j] < pivot) {
-            i++;
-            std::swap(arr[i], arr[j]);
-        }
+
+// Pattern-defeating quicksort (Orson Peters' pdqsort): introsort with the cases that usually hurt quicksort
+// turned into wins. Small ranges are insertion sorted. Pivots are the median of 3, or the ninther above
+// NINTHER_THRESHOLD elements. Arithmetic keys are partitioned with BlockQuicksort's branchless offset blocks.
+// A partition that moved nothing suggests sorted input, so both halves get a bounded insertion sort that gives up
+// after PARTIAL_INSERTION_LIMIT moves. A badly unbalanced split shuffles a few elements to break the pattern, and
+// after log2(n) of those the range is heapsorted instead. Runs of the pivot's equal elements are split off
+// whole. The smaller side is recursed into and the larger one looped on, so the stack stays O(log n).
+constexpr size_t INSERTION_THRESHOLD = 24;
+constexpr size_t NINTHER_THRESHOLD = 128;
+constexpr size_t PARTIAL_INSERTION_LIMIT = 8;
+constexpr size_t BLOCK = 64;
+
+// Insertion sort for a range that is not leftmost: *(first - 1) is no greater than anything in it, so the inner
+// loop needs no bounds check.
+template <typename It, typename Less>
+void unguarded_insertion(It first, It last, Less& less) {
+    if (first == last) return;
+    for (It cur = first + 1; cur < last; ++cur) {
+        if (!less(*cur, *(cur - 1))) continue;
+        auto key = std::move(*cur);
+        It sift = cur;
+        do {
+            *sift = std::move(*(sift - 1));
+            --sift;
+        } while (less(key, *(sift - 1)));
+        *sift = std::move(key);
     }
-    std::swap(arr[i + 1], arr[high]);
-    return i + 1;
 }
-void mergeHelp(std::vector<int>& arr, int left, int mid, int right) { // For MERGE ---
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
 
-    std::vector<int> leftArr(n1), rightArr(n2);
+// Insertion sort that gives up, returning false, once it has moved elements PARTIAL_INSERTION_LIMIT places.
+template <typename It, typename Less>
+bool partial_insertion(It first, It last, Less& less) {
+    if (first == last) return true;
+    size_t moves = 0;
+    for (It cur = first + 1; cur != last; ++cur) {
+        if (moves > PARTIAL_INSERTION_LIMIT) return false;
+        if (!less(*cur, *(cur - 1))) continue;
+        auto key = std::move(*cur);
+        It sift = cur;
+        do {
+            *sift = std::move(*(sift - 1));
+            --sift;
+        } while (sift != first && less(key, *(sift - 1)));
+        *sift = std::move(key);
+        moves += cur - sift;
+    }
+    return true;
+}
 
-    for (int i = 0; i < n1; i++)
-        leftArr[i] = arr[left + i];
-    for (int j = 0; j < n2; j++)
-        rightArr[j] = arr[mid + 1 + j];
+template <typename It, typename Less>
+void sort2(It a, It b, Less& less) {
+    if (less(*b, *a)) std::iter_swap(a, b);
+}
+template <typename It, typename Less>
+void sort3(It a, It b, It c, Less& less) {
+    sort2(a, b, less);
+    sort2(b, c, less);
+    sort2(a, b, less);
+}
 
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        if (leftArr[i] <= rightArr[j]) {
-            arr[k] = leftArr[i];
-            i++;
-        } else {
-            arr[k] = rightArr[j];
-            j++;
-        }
-        k++;
+// Partitions [first, last) around the pivot *first into < pivot and >= pivot, and returns where the pivot
+// ended up and whether nothing had to move. Median-of-3 guarantees an element >= pivot to stop the scans.
+template <typename It, typename Less>
+std::pair<It, bool> partition_right(It first, It last, Less& less) {
+    auto pivot = std::move(*first);
+    It lo = first, hi = last;
+    while (less(*++lo, pivot));
+    if (lo - 1 == first) while (lo < hi && !less(*--hi, pivot));
+    else while (!less(*--hi, pivot));
+    bool already = lo >= hi;
+    while (lo < hi) {
+        std::iter_swap(lo, hi);
+        while (less(*++lo, pivot));
+        while (!less(*--hi, pivot));
     }
+    It pivot_at = lo - 1;
+    *first = std::move(*pivot_at);
+    *pivot_at = std::move(pivot);
+    return {pivot_at, already};
+}
 
-    while (i < n1) {
-        arr[k] = leftArr[i];
-        i++;
-        k++;
+// Swaps num misplaced pairs found by the block scans. Unless each side found the same number, a cyclic
+// permutation does it with one move per element instead of three.
+template <typename It>
+void swap_offsets(It left, It right, const unsigned char* offsets_l, const unsigned char* offsets_r, size_t num, bool use_swaps) {
+    if (use_swaps) { // needed to stay linear on descending input
+        for (size_t i = 0; i < num; ++i) std::iter_swap(left + offsets_l[i], right - offsets_r[i]);
+    } else if (num > 0) {
+        It l = left + offsets_l[0];
+        It r = right - offsets_r[0];
+        auto tmp = std::move(*l);
+        *l = std::move(*r);
+        for (size_t i = 1; i < num; ++i) {
+            l = left + offsets_l[i];
+            *r = std::move(*l);
+            r = right - offsets_r[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(tmp);
     }
+}
 
-    while (j < n2) {
-        arr[k] = rightArr[j];
-        j++;
-        k++;
+// partition_right without data-dependent branches in the scans: each side records, for a block of BLOCK
+// elements, the offsets of the elements on the wrong side, then the two offset lists are swapped pairwise.
+template <typename It, typename Less>
+std::pair<It, bool> partition_right_branchless(It begin, It end, Less& less) {
+    auto pivot = std::move(*begin);
+    It first = begin, last = end;
+    while (less(*++first, pivot));
+    if (first - 1 == begin) while (first < last && !less(*--last, pivot));
+    else while (!less(*--last, pivot));
+    bool already = first >= last;
+    if (!already) {
+        std::iter_swap(first, last);
+        ++first;
+        alignas(64) unsigned char offsets_l[BLOCK];
+        alignas(64) unsigned char offsets_r[BLOCK];
+        It base_l = first, base_r = last;
+        size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+        while (first < last) {
+            size_t unknown = last - first;
+            size_t split_l = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+            size_t split_r = num_r == 0 ? unknown - split_l : 0;
+            for (size_t i = 0, n = std::min(split_l, BLOCK); i < n;) {
+                offsets_l[num_l] = i++;
+                num_l += !less(*first, pivot);
+                ++first;
+            }
+            for (size_t i = 0, n = std::min(split_r, BLOCK); i < n;) {
+                offsets_r[num_r] = ++i;
+                num_r += less(*--last, pivot);
+            }
+            size_t num = std::min(num_l, num_r);
+            swap_offsets(base_l, base_r, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+            if (num_l == 0) {
+                start_l = 0;
+                base_l = first;
+            }
+            if (num_r == 0) {
+                start_r = 0;
+                base_r = last;
+            }
+        }
+        // One side may still hold misplaced elements; they go next to the boundary.
+        if (num_l) {
+            while (num_l--) std::iter_swap(base_l + offsets_l[start_l + num_l], --last);
+            first = last;
+        }
+        if (num_r) {
+            while (num_r--) std::iter_swap(base_r - offsets_r[start_r + num_r], first++);
+            last = first;
+        }
     }
+    It pivot_at = first - 1;
+    *begin = std::move(*pivot_at);
+    *pivot_at = std::move(pivot);
+    return {pivot_at, already};
 }
 
+// Partitions around *first into <= pivot and > pivot, for when the pivot equals the element just before the
+// range: everything left of the result is then equal and already in place.
+template <typename It, typename Less>
+It partition_left(It first, It last, Less& less) {
+    auto pivot = std::move(*first);
+    It lo = first, hi = last;
+    while (less(pivot, *--hi));
+    if (hi + 1 == last) while (lo < hi && !less(pivot, *++lo));
+    else while (!less(pivot, *++lo));
+    while (lo < hi) {
+        std::iter_swap(lo, hi);
+        while (less(pivot, *--hi));
+        while (!less(pivot, *++lo));
+    }
+    *first = std::move(*hi);
+    *hi = std::move(pivot);
+    return hi;
+}
 
+template <bool Branchless, typename It, typename Less>
+void pdq(It begin, It end, Less& less, int bad_allowed, bool leftmost) {
+    while (true) {
+        size_t size = end - begin;
+        if (size < INSERTION_THRESHOLD) {
+            if (leftmost) insertion(begin, end, less);
+            else unguarded_insertion(begin, end, less);
+            return;
+        }
+        size_t half = size / 2;
+        if (size > NINTHER_THRESHOLD) {
+            sort3(begin, begin + half, end - 1, less);
+            sort3(begin + 1, begin + (half - 1), end - 2, less);
+            sort3(begin + 2, begin + (half + 1), end - 3, less);
+            sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+            std::iter_swap(begin, begin + half);
+        } else {
+            sort3(begin + half, begin, end - 1, less);
+        }
 
+        // Nothing here is less than *(begin - 1), the previous pivot. If this pivot equals it, the equal
+        // elements are split off to the left, where they are done.
+        if (!leftmost && !less(*(begin - 1), *begin)) {
+            begin = partition_left(begin, end, less) + 1;
+            continue;
+        }
 
+        auto [pivot, already] = Branchless ? partition_right_branchless(begin, end, less) : partition_right(begin, end, less);
+        size_t l_size = pivot - begin;
+        size_t r_size = end - (pivot + 1);
+        if (l_size < size / 8 || r_size < size / 8) {
+            if (--bad_allowed == 0) {
+                std::make_heap(begin, end, less);
+                std::sort_heap(begin, end, less);
+                return;
+            }
+            if (l_size >= INSERTION_THRESHOLD) {
+                std::iter_swap(begin, begin + l_size / 4);
+                std::iter_swap(pivot - 1, pivot - l_size / 4);
+                if (l_size > NINTHER_THRESHOLD) {
+                    std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+                    std::iter_swap(pivot - 2, pivot - (l_size / 4 + 1));
+                    std::iter_swap(pivot - 3, pivot - (l_size / 4 + 2));
+                }
+            }
+            if (r_size >= INSERTION_THRESHOLD) {
+                std::iter_swap(pivot + 1, pivot + (1 + r_size / 4));
+                std::iter_swap(end - 1, end - r_size / 4);
+                if (r_size > NINTHER_THRESHOLD) {
+                    std::iter_swap(pivot + 2, pivot + (2 + r_size / 4));
+                    std::iter_swap(pivot + 3, pivot + (3 + r_size / 4));
+                    std::iter_swap(end - 2, end - (1 + r_size / 4));
+                    std::iter_swap(end - 3, end - (2 + r_size / 4));
+                }
+            }
+        } else if (already && partial_insertion(begin, pivot, less) && partial_insertion(pivot + 1, end, less)) {
+            return;
+        }
 
+        if (l_size < r_size) {
+            pdq<Branchless>(begin, pivot, less, bad_allowed, leftmost);
+            begin = pivot + 1;
+            leftmost = false;
+        } else {
+            pdq<Branchless>(pivot + 1, end, less, bad_allowed, false);
+            end = pivot;
+        }
+    }
+}
 
-namespace sort{
+template <typename It, typename T, typename Less>
+void merge(It first, size_t left, size_t mid, size_t right, std::vector<T>& buffer, Less& less) {
+    buffer.assign(std::make_move_iterator(first + left), std::make_move_iterator(first + mid));
+    size_t i = 0, j = mid, k = left;
+    while (i < buffer.size() && j < right) {
+        if (less(first[j], buffer[i])) first[k++] = std::move(first[j++]);
+        else first[k++] = std::move(buffer[i++]); // ties take the left run first, which keeps it stable
+    }
+    std::move(buffer.begin() + i, buffer.end(), first + k);
+}
+template <typename It, typename T, typename Less>
+void merge_sort(It first, size_t left, size_t right, std::vector<T>& buffer, Less& less) { // [left, right)
+    if (right - left < 2) return;
+    size_t mid = left + (right - left) / 2;
+    merge_sort(first, left, mid, buffer, less);
+    merge_sort(first, mid, right, buffer, less);
+    if (less(first[mid], first[mid - 1])) merge(first, left, mid, right, buffer, less);
+}
 
+// Radix sorts order by the bits of a key mapped so that unsigned comparison agrees with the key's own order:
+// signed integers get their sign bit flipped, IEEE floats get every bit flipped if negative and the sign bit set
+// otherwise. That puts -0.0 before 0.0, and NaNs at the ends according to their sign bit.
+template <typename K>
+concept RadixKey = (std::integral<K> && sizeof(K) <= 8) ||
+                   (std::floating_point<K> && std::numeric_limits<K>::is_iec559 && (sizeof(K) == 4 || sizeof(K) == 8));
 
+template <RadixKey K>
+auto ordered_bits(K key) {
+    if constexpr (std::same_as<K, bool>) {
+        return uint8_t(key);
+    } else if constexpr (std::integral<K>) {
+        using U = std::make_unsigned_t<K>;
+        U bits = U(key);
+        if constexpr (std::is_signed_v<K>) bits ^= U(U(1) << (8 * sizeof(U) - 1));
+        return bits;
+    } else {
+        using U = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+        U bits = std::bit_cast<U>(key);
+        constexpr U sign = U(1) << (8 * sizeof(U) - 1);
+        return bits & sign ? U(~bits) : U(bits | sign);
+    }
+}
 
+constexpr size_t DIGIT_BITS = 8; // 256 counters per digit stay in L1
+constexpr size_t BUCKETS = size_t(1) << DIGIT_BITS;
+constexpr size_t RADIX_CUTOFF = 64; // below this, insertion sort beats clearing a histogram
 
+// Payload type carried next to the keys by lsd(); nullptr_t for none.
+template <typename Values>
+struct Payload {
+    using type = std::iter_value_t<Values>;
+};
+template <>
+struct Payload<std::nullptr_t> {
+    using type = std::byte;
+};
 
-void radix(std::vector<int>& arr) {
- int maxVal = *std::max_element(arr.begin(), arr.end());
+// Stable LSD radix sort of [first, first + n) by ordered_bits(bits(element)), moving values[i] along with
+// first[i] if values is not nullptr. One read builds the histograms of every digit; a digit all keys share
+// costs no pass. Each pass scatters into the other of the range and a same-sized buffer.
+template <typename It, typename Bits, typename Values>
+void lsd(It first, size_t n, Bits& bits, Values values) {
+    constexpr bool has_values = !std::is_same_v<Values, std::nullptr_t>;
+    using U = decltype(ordered_bits(std::invoke(bits, *first)));
+    constexpr size_t DIGITS = 8 * sizeof(U) / DIGIT_BITS;
+    auto digit = [&](auto& element, size_t d) { return size_t(ordered_bits(std::invoke(bits, element)) >> (d * DIGIT_BITS)) & (BUCKETS - 1); };
 
-     for (int exp = 1; maxVal / exp > 0; exp *= 10)
-        countingSort(arr, exp);
+    std::vector<std::array<size_t, BUCKETS>> count(DIGITS);
+    for (size_t i = 0; i < n; ++i) {
+        U key = ordered_bits(std::invoke(bits, first[i]));
+        for (size_t d = 0; d < DIGITS; ++d) ++count[d][size_t(key >> (d * DIGIT_BITS)) & (BUCKETS - 1)];
+    }
+    std::vector<size_t> passes;
+    for (size_t d = 0; d < DIGITS; ++d) {
+        if (count[d][digit(first[0], d)] == n) continue;
+        size_t sum = 0;
+        for (size_t& c : count[d]) sum += std::exchange(c, sum); // now the start of each bucket
+        passes.push_back(d);
+    }
+    if (passes.empty()) return;
 
+    std::vector<std::iter_value_t<It>> buffer(std::make_move_iterator(first), std::make_move_iterator(first + n));
+    std::vector<typename Payload<Values>::type> value_buffer;
+    if constexpr (has_values) value_buffer.assign(std::make_move_iterator(values), std::make_move_iterator(values + n));
+    bool in_buffer = true; // where the elements are now; each pass moves them to the other side
+    for (size_t d : passes) {
+        auto scatter = [&](auto from, auto to, auto from_values, auto to_values) {
+            auto& start = count[d];
+            for (size_t i = 0; i < n; ++i) {
+                size_t at = start[digit(from[i], d)]++;
+                to[at] = std::move(from[i]);
+                if constexpr (has_values) to_values[at] = std::move(from_values[i]);
+            }
+        };
+        if (in_buffer) scatter(buffer.begin(), first, value_buffer.begin(), values);
+        else scatter(first, buffer.begin(), values, value_buffer.begin());
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer) {
+        std::move(buffer.begin(), buffer.end(), first);
+        if constexpr (has_values) std::move(value_buffer.begin(), value_buffer.end(), values);
+    }
 }
 
-void insertion(std::vector<int>& arr) {
-    for (size_t i = 1; i < arr.size(); ++i) {
-        int key = arr[i];
-        int j = i - 1;
-        while (j >= 0 && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            --j;
+// In-place MSD radix sort (American flag sort) of [first, first + n) on the digit at shift and those below:
+// count the digit, then swap each element straight into its bucket, then sort each bucket on the next digit.
+template <typename It, typename Bits>
+void american_flag(It first, size_t n, int shift, Bits& bits) {
+    auto digit = [&](auto& element) { return size_t(ordered_bits(std::invoke(bits, element)) >> shift) & (BUCKETS - 1); };
+    while (n >= RADIX_CUTOFF) {
+        std::array<size_t, BUCKETS> count{};
+        for (size_t i = 0; i < n; ++i) ++count[digit(first[i])];
+        if (count[digit(first[0])] == n) { // every key shares this digit
+            if (shift == 0) return;
+            shift -= DIGIT_BITS;
+            continue;
         }
-        arr[j + 1] = key;
+        std::array<size_t, BUCKETS> head, tail;
+        for (size_t d = 0, sum = 0; d < BUCKETS; ++d) {
+            head[d] = sum;
+            tail[d] = sum += count[d];
+        }
+        for (size_t d = 0; d < BUCKETS; ++d) {
+            while (head[d] < tail[d]) {
+                size_t to = digit(first[head[d]]);
+                if (to == d) ++head[d];
+                else std::iter_swap(first + head[d], first + head[to]++);
+            }
+        }
+        if (shift == 0) return;
+        for (size_t d = 0, start = 0; d < BUCKETS; start += count[d++]) {
+            if (count[d] > 1) american_flag(first + start, count[d], shift - DIGIT_BITS, bits);
+        }
+        return;
     }
+    auto key = [&](auto& element) { return ordered_bits(std::invoke(bits, element)); };
+    std::ranges::less cmp;
+    Less<std::ranges::less, decltype(key)> less{cmp, key};
+    insertion(first, first + n, less);
 }
 
-void quick(std::vector<int>& arr, int low = 0, int high = -1) {
-    if (high == -1) {
-        high = arr.size() - 1;
-    }
-    if (low < high) {
-        int pi = partition(arr, low, high);
-        quick(arr, low, pi - 1);
-        quick(arr, pi + 1, high);
-    }
 }
-   
-void merge(std::vector<int>& arr, int left = 0, int right = -1) {
-    if (right == -1) {
-        right = arr.size() - 1;
+
+namespace sort {
+
+template <std::random_access_iterator It, typename Compare = std::ranges::less, typename Proj = std::identity>
+void insertion(It first, It last, Compare cmp = {}, Proj proj = {}) {
+    sort_detail::Less<Compare, Proj> less{cmp, proj};
+    sort_detail::insertion(first, last, less);
+}
+
+// Not stable. O(n log n) worst case, O(n) on ascending, strictly descending or all-equal input.
+template <std::random_access_iterator It, typename Compare = std::ranges::less, typename Proj = std::identity>
+void quick(It first, It last, Compare cmp = {}, Proj proj = {}) {
+    sort_detail::Less<Compare, Proj> less{cmp, proj};
+    size_t n = last - first;
+    size_t descending = 1;
+    while (descending < n && less(first[descending], first[descending - 1])) ++descending;
+    if (n > 1 && descending == n) {
+        std::reverse(first, last);
+        return;
     }
-    
-    if (left < right) {
-        int mid = left + (right - left) / 2;
+    using Key = std::remove_cvref_t<std::invoke_result_t<Proj&, std::iter_reference_t<It>>>;
+    sort_detail::pdq<std::is_arithmetic_v<Key>>(first, last, less, std::bit_width(n), true);
+}
 
-        merge(arr, left, mid);
-        merge(arr, mid + 1, right);
+// Stable. Uses a buffer of half the range.
+template <std::random_access_iterator It, typename Compare = std::ranges::less, typename Proj = std::identity>
+void merge(It first, It last, Compare cmp = {}, Proj proj = {}) {
+    sort_detail::Less<Compare, Proj> less{cmp, proj};
+    std::vector<std::iter_value_t<It>> buffer;
+    buffer.reserve((last - first + 1) / 2);
+    sort_detail::merge_sort(first, 0, last - first, buffer, less);
+}
 
-        mergeHelp(arr, left, mid, right);
+// Stable LSD radix sort on 8-bit digits of proj(element), which may be any integer or IEEE float up to 64 bits
+// (see ordered_bits for where -0.0 and NaNs go). Uses a buffer the size of the range.
+template <std::random_access_iterator It, typename Proj = std::identity>
+    requires sort_detail::RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::iter_reference_t<It>>>>
+void radix(It first, It last, Proj proj = {}) {
+    size_t n = last - first;
+    if (n < sort_detail::RADIX_CUTOFF) {
+        auto key = [&](auto& element) { return sort_detail::ordered_bits(std::invoke(proj, element)); };
+        insertion(first, last, std::ranges::less(), key);
+        return;
     }
+    sort_detail::lsd(first, n, proj, nullptr);
+}
+
+// radix() on the keys [first, last), applying the same permutation to the values starting at `values`.
+template <std::random_access_iterator KeyIt, std::random_access_iterator ValueIt, typename Proj = std::identity>
+    requires sort_detail::RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::iter_reference_t<KeyIt>>>>
+void radix_by_key(KeyIt first, KeyIt last, ValueIt values, Proj proj = {}) {
+    size_t n = last - first;
+    if (n < 2) return;
+    sort_detail::lsd(first, n, proj, values);
+}
+
+// Unstable, but sorts in place: the same keys as radix() without its buffer, for arrays too large to double.
+template <std::random_access_iterator It, typename Proj = std::identity>
+    requires sort_detail::RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::iter_reference_t<It>>>>
+void radix_in_place(It first, It last, Proj proj = {}) {
+    using Key = std::remove_cvref_t<std::invoke_result_t<Proj&, std::iter_reference_t<It>>>;
+    size_t n = last - first;
+    if (n < 2) return;
+    sort_detail::american_flag(first, n, 8 * sizeof(Key) - sort_detail::DIGIT_BITS, proj);
+}
+
+template <std::ranges::random_access_range R, typename Compare = std::ranges::less, typename Proj = std::identity>
+void insertion(R&& r, Compare cmp = {}, Proj proj = {}) {
+    insertion(std::ranges::begin(r), std::ranges::begin(r) + std::ranges::distance(r), cmp, proj);
+}
+template <std::ranges::random_access_range R, typename Compare = std::ranges::less, typename Proj = std::identity>
+void quick(R&& r, Compare cmp = {}, Proj proj = {}) {
+    quick(std::ranges::begin(r), std::ranges::begin(r) + std::ranges::distance(r), cmp, proj);
+}
+template <std::ranges::random_access_range R, typename Compare = std::ranges::less, typename Proj = std::identity>
+void merge(R&& r, Compare cmp = {}, Proj proj = {}) {
+    merge(std::ranges::begin(r), std::ranges::begin(r) + std::ranges::distance(r), cmp, proj);
+}
+template <std::ranges::random_access_range R, typename Proj = std::identity>
+    requires sort_detail::RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::ranges::range_reference_t<R>>>>
+void radix(R&& r, Proj proj = {}) {
+    radix(std::ranges::begin(r), std::ranges::begin(r) + std::ranges::distance(r), proj);
+}
+template <std::ranges::random_access_range K, std::ranges::random_access_range V, typename Proj = std::identity>
+    requires sort_detail::RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::ranges::range_reference_t<K>>>>
+void radix_by_key(K&& keys, V&& values, Proj proj = {}) {
+    if (std::ranges::distance(values) < std::ranges::distance(keys)) throw std::invalid_argument("fewer values than keys");
+    radix_by_key(std::ranges::begin(keys), std::ranges::begin(keys) + std::ranges::distance(keys), std::ranges::begin(values), proj);
+}
+template <std::ranges::random_access_range R, typename Proj = std::identity>
+    requires sort_detail::RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::ranges::range_reference_t<R>>>>
+void radix_in_place(R&& r, Proj proj = {}) {
+    radix_in_place(std::ranges::begin(r), std::ranges::begin(r) + std::ranges::distance(r), proj);
 }
 
 }
-#endif // SORT_HPP
\ No newline at end of file
+#endif // SORT_HPP
@@ -0,0 +1,342 @@
+#ifndef UNROLLED_LIST_HPP
+#define UNROLLED_LIST_HPP
+
+#include "list.hpp"
+#include "node_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+inline constexpr size_t CACHE_LINE = 64;
+
+// Same interface as List, but each link holds a cache-line-aligned block of up to CAPACITY elements stored
+// contiguously, so traversal streams through memory instead of chasing one pointer per element.
+//
+// A full block splits in half when something is inserted into it, except at the two ends of the list, where a
+// new block is started instead so that pushl and pushr leave blocks full. A block that drops below half full
+// merges with a neighbour if the two fit in one block. Positional operations walk blocks rather than elements:
+// still linear, but CAPACITY times shorter. Any insert or delete invalidates iterators.
+template <typename T, size_t BlockBytes = 4 * CACHE_LINE>
+class UnrolledList {
+    static constexpr size_t HEADER = (2 * sizeof(void*) + sizeof(uint32_t) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+public:
+    static constexpr size_t CAPACITY = std::max<size_t>(2, (BlockBytes - std::min(BlockBytes, HEADER)) / sizeof(T));
+
+private:
+    struct alignas(CACHE_LINE) Block {
+        Block* next = nullptr;
+        Block* prev = nullptr;
+        uint32_t count = 0;
+        alignas(T) std::byte storage[CAPACITY * sizeof(T)];
+
+        T* data() { return std::launder(reinterpret_cast<T*>(storage)); }
+        const T* data() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+    };
+
+    size_t _length = 0;
+    Block* _begin = nullptr;
+    Block* _back = nullptr;
+    NodePool<Block> _pool;
+
+    Block* new_block(Block* prev, Block* next) {
+        Block* b = new (_pool.allocate()) Block;
+        b->prev = prev;
+        b->next = next;
+        (prev ? prev->next : _begin) = b;
+        (next ? next->prev : _back) = b;
+        return b;
+    }
+    void free_block(Block* b) { // b must already be empty
+        (b->prev ? b->prev->next : _begin) = b->next;
+        (b->next ? b->next->prev : _back) = b->prev;
+        b->~Block();
+        _pool.deallocate(b);
+    }
+
+    // Moves the upper half of a full block into a new block after it.
+    void split(Block* b) {
+        Block* n = new_block(b, b->next);
+        uint32_t half = b->count / 2;
+        std::uninitialized_move(b->data() + half, b->data() + b->count, n->data());
+        std::destroy(b->data() + half, b->data() + b->count);
+        n->count = b->count - half;
+        b->count = half;
+    }
+    // Appends the block after b to b and frees it; the two must fit in one block.
+    void merge(Block* b) {
+        Block* n = b->next;
+        std::uninitialized_move(n->data(), n->data() + n->count, b->data() + b->count);
+        std::destroy(n->data(), n->data() + n->count);
+        b->count += n->count;
+        n->count = 0;
+        free_block(n);
+    }
+
+    static void insert_at(Block* b, size_t at, const T& val) { // b must have room
+        T* d = b->data();
+        if (at == b->count) {
+            new (d + at) T(val);
+        } else {
+            T copy(val); // val may be one of the elements about to shift
+            new (d + b->count) T(std::move(d[b->count - 1]));
+            std::move_backward(d + at, d + b->count - 1, d + b->count);
+            d[at] = std::move(copy);
+        }
+        ++b->count;
+    }
+    static void erase_at(Block* b, size_t at) {
+        T* d = b->data();
+        std::move(d + at + 1, d + b->count, d + at);
+        std::destroy_at(d + b->count - 1);
+        --b->count;
+    }
+
+    std::pair<Block*, size_t> locate(size_t pos) const { // pos < _length
+        if (pos < _length / 2) {
+            Block* b = _begin;
+            for (; pos >= b->count; b = b->next) pos -= b->count;
+            return {b, pos};
+        }
+        size_t from_back = _length - pos;
+        Block* b = _back;
+        for (; from_back > b->count; b = b->prev) from_back -= b->count;
+        return {b, b->count - from_back};
+    }
+
+public:
+
+    class iterator {
+        friend class UnrolledList;
+        Block* _block;
+        size_t _index;
+    public:
+        iterator(Block* block = nullptr, size_t index = 0) : _block(block), _index(index) {}
+        iterator& operator++() {
+            if (++_index == _block->count) {
+                _block = _block->next;
+                _index = 0;
+            }
+            return *this;
+        }
+        iterator& operator--() {
+            if (_index == 0) {
+                _block = _block->prev;
+                _index = _block->count;
+            }
+            --_index;
+            return *this;
+        }
+        T& operator*() const { return _block->data()[_index]; }
+        bool operator==(const iterator& rhs) const { return _block == rhs._block && _index == rhs._index; }
+        bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    class const_iterator {
+        friend class UnrolledList;
+        const Block* _block;
+        size_t _index;
+    public:
+        const_iterator(const Block* block = nullptr, size_t index = 0) : _block(block), _index(index) {}
+        const_iterator& operator++() {
+            if (++_index == _block->count) {
+                _block = _block->next;
+                _index = 0;
+            }
+            return *this;
+        }
+        const_iterator& operator--() {
+            if (_index == 0) {
+                _block = _block->prev;
+                _index = _block->count;
+            }
+            --_index;
+            return *this;
+        }
+        const T& operator*() const { return _block->data()[_index]; }
+        bool operator==(const const_iterator& rhs) const { return _block == rhs._block && _index == rhs._index; }
+        bool operator!=(const const_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    UnrolledList() {}
+    UnrolledList(const std::initializer_list<T> il) {
+        for (const T& i : il) pushr(i);
+    }
+    UnrolledList(const UnrolledList& list) {
+        for (const T& i : list) pushr(i);
+    }
+    UnrolledList(const std::vector<T>& list) {
+        for (const T& i : list) pushr(i);
+    }
+    UnrolledList(const T* list, size_t length) {
+        for (size_t i = 0; i < length; ++i) pushr(list[i]);
+    }
+    UnrolledList(std::function<T(size_t)> fn, size_t length) {
+        for (size_t i = 0; i < length; ++i) pushr(fn(i));
+    }
+    UnrolledList& operator=(const UnrolledList& rhs) {
+        if (this != &rhs) {
+            clear();
+            for (const T& i : rhs) pushr(i);
+        }
+        return *this;
+    }
+    ~UnrolledList() { clear(); }
+
+    std::string string() const {
+        return (std::ostringstream() << *this).str();
+    }
+
+    size_t length() const { return _length; }
+    size_t size() const { return _length; }
+    bool is_empty() const { return _length == 0; }
+    size_t block_count() const {
+        size_t ret = 0;
+        for (Block* b = _begin; b; b = b->next) ++ret;
+        return ret;
+    }
+    void clear() {
+        if (!std::is_trivially_destructible_v<T> || !_pool.release()) {
+            while (_begin) {
+                std::destroy(_begin->data(), _begin->data() + _begin->count);
+                _begin->count = 0;
+                free_block(_begin);
+            }
+            _pool.release();
+        }
+        _length = 0;
+        _begin = _back = nullptr;
+    }
+
+    iterator begin() { return iterator(_begin); }
+    const_iterator begin() const { return const_iterator(_begin); }
+    iterator end() { return iterator(); }
+    const_iterator end() const { return const_iterator(); }
+    iterator back() { return _back ? iterator(_back, _back->count - 1) : end(); }
+    const_iterator back() const { return _back ? const_iterator(_back, _back->count - 1) : end(); }
+
+    T& operator[](int index) {
+        if (index < 0) index += _length;
+        if (index < 0 || size_t(index) >= _length) throw ListOutOfBounds();
+        size_t pos = index;
+        auto [b, at] = locate(pos);
+        return b->data()[at];
+    }
+    void insert(int index, const T val) {
+        if (index < 0) index += _length + 1;
+        if (index < 0 || size_t(index) > _length) throw ListOutOfBounds();
+        size_t pos = index;
+        Block* b;
+        size_t at;
+        if (pos == _length) {
+            b = _back && _back->count < CAPACITY ? _back : new_block(_back, nullptr);
+            at = b->count;
+        } else if (pos == 0) {
+            b = _begin->count < CAPACITY ? _begin : new_block(nullptr, _begin);
+            at = 0;
+        } else {
+            std::tie(b, at) = locate(pos);
+            if (b->count == CAPACITY) {
+                split(b);
+                if (at > b->count) {
+                    at -= b->count;
+                    b = b->next;
+                }
+            }
+        }
+        insert_at(b, at, val);
+        ++_length;
+    }
+    void del(int index) {
+        if (index < 0) index += _length;
+        if (index < 0 || size_t(index) >= _length) throw ListOutOfBounds();
+        size_t pos = index;
+        auto [b, at] = locate(pos);
+        erase_at(b, at);
+        --_length;
+        if (b->count == 0) {
+            free_block(b);
+        } else if (b->count < CAPACITY / 2) {
+            if (b->next && b->count + b->next->count <= CAPACITY) merge(b);
+            else if (b->prev && b->prev->count + b->count <= CAPACITY) merge(b->prev);
+        }
+    }
+    std::vector<size_t> find_vals(const T val) const {
+        std::vector<size_t> ret;
+        size_t index = 0;
+        for (Block* b = _begin; b; b = b->next) {
+            const T* d = b->data();
+            for (uint32_t i = 0; i < b->count; ++i, ++index) {
+                if (d[i] == val) ret.push_back(index);
+            }
+        }
+        return ret;
+    }
+    void del_vals(const T val) {
+        for (Block* b = _begin; b;) {
+            Block* next = b->next;
+            T* d = b->data();
+            T* kept = std::remove(d, d + b->count, val);
+            std::destroy(kept, d + b->count);
+            _length -= d + b->count - kept;
+            b->count = kept - d;
+            if (b->count == 0) free_block(b);
+            b = next;
+        }
+    }
+
+    void pushl(const T val) { insert(0, val); }
+    void pushr(const T val) { insert(-1, val); }
+    void popl() { del(0); }
+    void popr() { del(-1); }
+
+    bool operator==(const UnrolledList& rhs) const {
+        if (_length != rhs._length) return false;
+        for (auto l = begin(), r = rhs.begin(); l != end(); ++l, ++r) {
+            if (*l != *r) return false;
+        }
+        return true;
+    }
+    bool operator!=(const UnrolledList& rhs) const { return !(*this == rhs); }
+    template <typename Fn>
+    T reduce(Fn&& fn, T start = T()) const {
+        for (Block* b = _begin; b; b = b->next) {
+            const T* d = b->data();
+            for (uint32_t i = 0; i < b->count; ++i) start = fn(std::move(start), d[i]);
+        }
+        return start;
+    }
+    template <typename Fn>
+    void apply(Fn&& fn) {
+        for (Block* b = _begin; b; b = b->next) {
+            T* d = b->data();
+            for (uint32_t i = 0; i < b->count; ++i) d[i] = fn(std::move(d[i]));
+        }
+    }
+};
+
+template <typename T, size_t BlockBytes>
+std::ostream& operator<<(std::ostream& os, const UnrolledList<T, BlockBytes>& rhs) {
+    os << "{";
+    if (!rhs.is_empty()) {
+        for (auto i = rhs.begin(); i != rhs.back(); ++i) {
+            os << *i << ", ";
+        }
+        os << *rhs.back();
+    }
+    os << "}";
+    return os;
+}
+
+#endif // UNROLLED_LIST_HPP
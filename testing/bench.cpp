@@ -0,0 +1,446 @@
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "graph.hpp"
+#include "graph_file.hpp"
+#include "contraction_hierarchy.hpp"
+#include "list.hpp"
+#include "unrolled_list.hpp"
+#include "indexed_list.hpp"
+#include "sort.hpp"
+
+// Benchmarks live in their own executable (bench) and are not part of testall. Each one prints its timings
+// and checks that the contenders agree, so a fast-but-wrong result still fails.
+
+template <typename Fn>
+double seconds(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+CsrGraph<int> random_csr(int n, size_t m, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> node(0, n - 1);
+    std::uniform_real_distribution<double> weight(0, 10);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges(m);
+    for (auto& edge : edges) edge = {node(rng), node(rng), weight(rng)};
+    return CsrGraph<int>(std::move(keys), edges);
+}
+
+std::vector<size_t> thread_counts() {
+    std::vector<size_t> ret;
+    for (size_t t = 1; t < std::thread::hardware_concurrency(); t *= 2) ret.push_back(t);
+    ret.push_back(std::max(1u, std::thread::hardware_concurrency()));
+    return ret;
+}
+
+TEST(Benchmark, DeltaStepping) {
+    CsrGraph<int> g = random_csr(1 << 20, 8 << 20, 1);
+    ShortestPaths expected;
+    double base = seconds([&] { expected = dijkstra(g, 0); });
+    std::cout << "dijkstra: " << base << "s" << std::endl;
+    for (size_t threads : thread_counts()) {
+        parallel::ThreadPool pool(threads);
+        ShortestPaths sp;
+        double t = seconds([&] { sp = delta_stepping(g, 0, 0, pool); });
+        std::cout << "delta_stepping, " << threads << " threads: " << t << "s (" << base / t << "x)" << std::endl;
+        EXPECT_EQ(sp.dist, expected.dist);
+    }
+}
+
+TEST(Benchmark, MaxFlow) {
+    const int n = 100000;
+    CsrGraph<int> g = random_csr(n, 1 << 20, 2);
+    FlowNetwork<long long> a(n), b(n);
+    for (uint32_t u = 0; u < g.size(); ++u) {
+        for (size_t i = 0; i < g.degree(u); ++i) {
+            a.add_edge(u, g.targets(u)[i], 1 + g.weights(u)[i] * 100);
+            b.add_edge(u, g.targets(u)[i], 1 + g.weights(u)[i] * 100);
+        }
+    }
+    for (uint32_t i = 1; i <= 2000; ++i) { // wide source and sink so the flow has to spread through the graph
+        uint32_t spread = i * 37 % (n - 2) + 1;
+        a.add_edge(0, spread, 10000);
+        b.add_edge(0, spread, 10000);
+        a.add_edge(n - 1 - spread, n - 1, 10000);
+        b.add_edge(n - 1 - spread, n - 1, 10000);
+    }
+    long long dinic, push_relabel;
+    std::cout << "dinic: " << seconds([&] { dinic = a.dinic(0, n - 1); }) << "s" << std::endl;
+    std::cout << "push_relabel: " << seconds([&] { push_relabel = b.push_relabel(0, n - 1); }) << "s" << std::endl;
+    EXPECT_EQ(dinic, push_relabel);
+}
+
+TEST(Benchmark, BulkLoad) {
+    const int n = 1 << 20;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> node(0, n - 1);
+    std::uniform_real_distribution<double> weight(0, 10);
+    std::vector<std::tuple<int, int, double>> edges(8 << 20);
+    for (auto& edge : edges) edge = {node(rng), node(rng), weight(rng)};
+    Graph<int> expected;
+    for (int i = 0; i < n; ++i) expected.clear_node(i);
+    double base = seconds([&] {
+        for (const auto& [begin, end, w] : edges) expected.update_edge(begin, end, w);
+    });
+    std::cout << "update_edge loop: " << base << "s" << std::endl;
+    for (size_t threads : thread_counts()) {
+        parallel::ThreadPool pool(threads);
+        Graph<int> g;
+        for (int i = 0; i < n; ++i) g.clear_node(i);
+        double t = seconds([&] { g.bulk_load(edges, pool); });
+        std::cout << "bulk_load, " << threads << " threads: " << t << "s (" << base / t << "x)" << std::endl;
+        EXPECT_EQ(g.edge_count(), expected.edge_count());
+    }
+    double t = seconds([&] {
+        for (int i = 0; i < n; i += 64) expected.del_node(i);
+    });
+    std::cout << "del_node x" << n / 64 << ": " << t << "s" << std::endl;
+}
+
+TEST(Benchmark, OpenCsr) {
+    CsrGraph<int> g = random_csr(1 << 20, 16 << 20, 4);
+    std::vector<std::tuple<int, int, double>> edges = g.edges();
+    std::string path = (std::filesystem::temp_directory_path() / "bench.csr").string();
+    write_csr(g, path);
+    CsrGraph<int> rebuilt, mapped;
+    double base = seconds([&] {
+        Graph<int> fresh;
+        for (int key : g.keys()) fresh.clear_node(key);
+        fresh.bulk_load(edges);
+        rebuilt = fresh.freeze();
+    });
+    std::cout << "rebuild from edge list: " << base << "s" << std::endl;
+    double t = seconds([&] { mapped = open_csr<int>(path); });
+    std::cout << "open_csr: " << t << "s (" << base / t << "x)" << std::endl;
+    double first = seconds([&] { EXPECT_EQ(bfs(mapped, 0).hops, bfs(rebuilt, 0).hops); });
+    std::cout << "first query on both: " << first << "s" << std::endl;
+    std::filesystem::remove(path);
+}
+
+TEST(Benchmark, PointToPoint) {
+    CsrGraph<int> g = random_csr(1 << 20, 4 << 20, 5);
+    CsrGraph<int> reverse = g.transpose();
+    std::mt19937 rng(6);
+    std::uniform_int_distribution<uint32_t> node(0, g.size() - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> queries(20);
+    for (auto& q : queries) q = {node(rng), node(rng)};
+    std::vector<double> expected, both, guided;
+    double base = seconds([&] {
+        for (auto [s, t] : queries) expected.push_back(dijkstra(g, s).dist[t]);
+    });
+    double t = seconds([&] {
+        for (auto [s, t] : queries) both.push_back(bidirectional_dijkstra(g, reverse, s, t).dist);
+    });
+    double a = seconds([&] {
+        for (auto [s, t] : queries) guided.push_back(astar(g, s, t, [](uint32_t) { return 0.0; }).dist);
+    });
+    std::cout << "full dijkstra: " << base / queries.size() << "s per query" << std::endl;
+    std::cout << "bidirectional: " << t / queries.size() << "s per query (" << base / t << "x)" << std::endl;
+    std::cout << "astar, zero heuristic: " << a / queries.size() << "s per query (" << base / a << "x)" << std::endl;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (std::isinf(expected[i])) {
+            EXPECT_EQ(both[i], expected[i]);
+            EXPECT_EQ(guided[i], expected[i]);
+            continue;
+        }
+        EXPECT_NEAR(both[i], expected[i], 1e-9);
+        EXPECT_NEAR(guided[i], expected[i], 1e-9);
+    }
+}
+
+TEST(Benchmark, ContractionHierarchy) {
+    const uint32_t side = 200; // road-like: a grid with random travel times and a faster road every 16 blocks
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> weight(1, 10);
+    std::vector<int> keys(side * side);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges;
+    for (uint32_t r = 0; r < side; ++r) {
+        for (uint32_t c = 0; c < side; ++c) {
+            uint32_t v = r * side + c;
+            double row = r % 16 == 0 ? 0.2 : 1, column = c % 16 == 0 ? 0.2 : 1;
+            if (c + 1 < side) edges.insert(edges.end(), {{v, v + 1, row * weight(rng)}, {v + 1, v, row * weight(rng)}});
+            if (r + 1 < side) edges.insert(edges.end(), {{v, v + side, column * weight(rng)}, {v + side, v, column * weight(rng)}});
+        }
+    }
+    CsrGraph<int> g(keys, edges);
+    for (size_t threads : thread_counts()) {
+        parallel::ThreadPool pool(threads);
+        double t = seconds([&] { ContractionHierarchy(g, pool); });
+        std::cout << "contraction, " << threads << " threads: " << t << "s" << std::endl;
+    }
+    ContractionHierarchy ch(g);
+    std::cout << ch.shortcut_count() << " shortcuts over " << g.edge_count() << " edges" << std::endl;
+
+    std::uniform_int_distribution<uint32_t> node(0, g.size() - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> queries(1000);
+    for (auto& q : queries) q = {node(rng), node(rng)};
+    std::vector<double> expected, got;
+    double base = seconds([&] {
+        for (size_t i = 0; i < 20; ++i) expected.push_back(dijkstra(g, queries[i].first).dist[queries[i].second]);
+    }) / 20;
+    double t = seconds([&] {
+        for (auto [s, t] : queries) got.push_back(ch.distance(s, t));
+    }) / queries.size();
+    double unpacked = seconds([&] {
+        for (auto [s, t] : queries) ch.route(s, t);
+    }) / queries.size();
+    std::cout << "dijkstra: " << base * 1e6 << "us per query" << std::endl;
+    std::cout << "contraction hierarchy: " << t * 1e6 << "us per query (" << base / t << "x), "
+              << unpacked * 1e6 << "us with path unpacking" << std::endl;
+    for (size_t i = 0; i < expected.size(); ++i) EXPECT_NEAR(got[i], expected[i], 1e-9);
+}
+
+TEST(Benchmark, Reordering) {
+    const uint32_t side = 1000; // a grid whose ids have been scrambled, as ids from a hash-keyed ingest are
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<double> weight(1, 10);
+    std::vector<uint32_t> shuffle(side * side);
+    std::iota(shuffle.begin(), shuffle.end(), 0);
+    std::shuffle(shuffle.begin(), shuffle.end(), rng);
+    std::vector<int> keys(side * side);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges;
+    for (uint32_t v = 0; v < side * side; ++v) {
+        if (v % side + 1 < side) edges.insert(edges.end(), {{shuffle[v], shuffle[v + 1], weight(rng)}, {shuffle[v + 1], shuffle[v], weight(rng)}});
+        if (v + side < side * side) edges.insert(edges.end(), {{shuffle[v], shuffle[v + side], weight(rng)}, {shuffle[v + side], shuffle[v], weight(rng)}});
+    }
+    CsrGraph<int> scrambled(keys, edges);
+    std::vector<std::pair<std::string, CsrGraph<int>>> layouts;
+    layouts.push_back({"scrambled", scrambled});
+    double t = seconds([&] { layouts.push_back({"rcm", relabel(scrambled, reverse_cuthill_mckee(scrambled))}); });
+    std::cout << "reverse_cuthill_mckee + relabel: " << t << "s" << std::endl;
+    t = seconds([&] { layouts.push_back({"bfs", relabel(scrambled, bfs_order(scrambled))}); });
+    std::cout << "bfs_order + relabel: " << t << "s" << std::endl;
+    t = seconds([&] { layouts.push_back({"degree", relabel(scrambled, degree_order(scrambled))}); });
+    std::cout << "degree_order + relabel: " << t << "s" << std::endl;
+
+    double expected = 0;
+    for (const auto& [name, g] : layouts) {
+        CsrGraph<int> reverse = g.transpose();
+        uint32_t source = g.id(0);
+        ShortestPaths sp;
+        double b = seconds([&] { bfs(g, reverse, source); });
+        double d = seconds([&] { sp = dijkstra(g, source); });
+        double s = seconds([&] { strongly_connected_components(g); });
+        std::cout << name << ": bfs " << b << "s, dijkstra " << d << "s, scc " << s << "s" << std::endl;
+        double total = std::accumulate(sp.dist.begin(), sp.dist.end(), 0.0);
+        if (name == "scrambled") expected = total;
+        EXPECT_NEAR(total, expected, 1e-6 * expected);
+    }
+}
+
+TEST(Benchmark, DynamicShortestPaths) {
+    const int n = 1 << 20;
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<int> node(0, n - 1);
+    std::uniform_real_distribution<double> weight(0, 10);
+    std::vector<std::tuple<int, int, double>> edges(4 << 20);
+    for (auto& edge : edges) edge = {node(rng), node(rng), weight(rng)};
+    Graph<int> g;
+    for (int i = 0; i < n; ++i) g.clear_node(i);
+    g.bulk_load(edges);
+    std::optional<DynamicShortestPaths<int>> sp;
+    double base = seconds([&] { sp.emplace(g, 0); });
+    std::cout << "from scratch: " << base << "s" << std::endl;
+    for (size_t batch : {10, 100, 1000}) {
+        size_t changed = 0;
+        double t = seconds([&] {
+            for (size_t i = 0; i < batch; ++i) {
+                auto [begin, end, w] = edges[rng() % edges.size()];
+                if (i % 2) sp->update_edge(begin, end, w * (i % 4 == 1 ? 0.5 : 2)); // lighter or heavier
+                else sp->update_edge(node(rng), node(rng), weight(rng));
+            }
+            changed = sp->repair();
+        });
+        std::cout << "batch of " << batch << ": " << t << "s (" << base / t << "x), " << changed << " distances changed" << std::endl;
+    }
+    CsrGraph<int> frozen = g.freeze();
+    ShortestPaths expected = dijkstra(frozen, frozen.id(0));
+    for (uint32_t v = 0; v < frozen.size(); v += 97) {
+        if (std::isinf(expected.dist[v])) EXPECT_EQ(sp->distance(frozen.key(v)), expected.dist[v]);
+        else EXPECT_NEAR(sp->distance(frozen.key(v)), expected.dist[v], 1e-9);
+    }
+}
+
+TEST(Benchmark, ListNodes) {
+    const int n = 4 << 20;
+    auto run = [&](auto& ls, const char* name) {
+        long long sum = 0;
+        double build = seconds([&] { for (int i = 0; i < n; ++i) ls.pushr(i); });
+        double iterate = seconds([&] { for (int x : ls) sum += x; });
+        double clear = seconds([&] { ls.clear(); });
+        std::cout << name << ": build " << build << "s, iterate " << iterate << "s, clear " << clear << "s" << std::endl;
+        return sum;
+    };
+    List<int, HeapNodes<ListNode<int>>> heap;
+    List<int> pooled;
+    EXPECT_EQ(run(heap, "new/delete"), run(pooled, "NodePool"));
+}
+
+TEST(Benchmark, UnrolledList) {
+    const int n = 4 << 20, edits = 2000, small = 100000;
+    auto run = [&](auto& ls, const char* name) {
+        long long sum = 0;
+        double push = seconds([&] { for (int i = 0; i < n; ++i) ls.pushr(i); });
+        double iterate = seconds([&] { for (int x : ls) sum += x; });
+        double apply = seconds([&] { ls.apply([](int x) { return x * 3 + 1; }); });
+        for (int x : ls) sum += x;
+        ls.clear();
+        for (int i = 0; i < small; ++i) ls.pushr(i);
+        std::mt19937 rng(9);
+        double insert = seconds([&] {
+            for (int i = 0; i < edits; ++i) ls.insert(rng() % ls.size(), i);
+        });
+        sum += ls[small / 2];
+        std::cout << name << ": pushr " << push << "s, iterate " << iterate << "s, apply " << apply << "s, "
+                  << edits << " random inserts " << insert << "s" << std::endl;
+        return sum;
+    };
+    List<int> list;
+    UnrolledList<int> unrolled;
+    struct Vector : std::vector<int> { // the List calls spelled for a vector
+        void pushr(int x) { push_back(x); }
+        void insert(size_t pos, int x) { std::vector<int>::insert(begin() + pos, x); }
+        void apply(const std::function<int(int)>& fn) { for (int& x : *this) x = fn(x); }
+    } vector;
+    long long expected = run(vector, "std::vector");
+    EXPECT_EQ(run(list, "List"), expected);
+    EXPECT_EQ(run(unrolled, "UnrolledList"), expected);
+}
+
+TEST(Benchmark, IndexedList) {
+    const int n = 1 << 20, ops = 2000;
+    auto run = [&](auto& ls, const char* name) {
+        for (int i = 0; i < n; ++i) ls.pushr(i);
+        std::mt19937 rng(10);
+        long long sum = 0;
+        double t = seconds([&] {
+            for (int i = 0; i < ops; ++i) {
+                ls.insert(rng() % (ls.size() + 1), i);
+                sum += ls[rng() % ls.size()];
+                ls.del(rng() % ls.size());
+            }
+        });
+        std::cout << name << ": " << t / ops * 1e6 << "us per insert + index + del on " << n << " elements" << std::endl;
+        return sum;
+    };
+    List<int> list;
+    UnrolledList<int> unrolled;
+    IndexedList<int> indexed;
+    long long expected = run(list, "List");
+    EXPECT_EQ(run(unrolled, "UnrolledList"), expected);
+    EXPECT_EQ(run(indexed, "IndexedList"), expected);
+}
+
+TEST(Benchmark, ListParallelApply) {
+    const int n = 4 << 20;
+    auto work = [](double x) { // enough arithmetic per element that the run-cutting walk is not the bottleneck
+        for (int i = 0; i < 20; ++i) x = std::sqrt(x * x + i);
+        return x;
+    };
+    List<double> expected([](size_t i) { return double(i); }, n);
+    double base = seconds([&] { expected.apply(work); });
+    double sum = 0;
+    double base_reduce = seconds([&] { sum = expected.reduce(std::plus<>()); });
+    std::cout << "apply: " << base << "s, reduce: " << base_reduce << "s" << std::endl;
+    for (size_t threads : thread_counts()) {
+        parallel::ThreadPool pool(threads);
+        List<double> ls([](size_t i) { return double(i); }, n);
+        double t = seconds([&] { ls.apply(work, pool); });
+        double parallel_sum = 0;
+        double r = seconds([&] { parallel_sum = ls.reduce(std::plus<>(), 0.0, pool); });
+        std::cout << threads << " threads: apply " << t << "s (" << base / t << "x), reduce " << r << "s" << std::endl;
+        EXPECT_TRUE(ls == expected);
+        EXPECT_NEAR(parallel_sum, sum, 1e-9 * sum);
+    }
+}
+
+TEST(Benchmark, ListSplice) {
+    const int n = 1 << 20;
+    List<int> a([](size_t i) -> int { return i; }, n), b;
+    double copied = seconds([&] {
+        while (!a.is_empty()) {
+            b.pushr(*a.begin());
+            a.popl();
+        }
+    });
+    const int rounds = 100000;
+    double relinked = seconds([&] {
+        for (int i = 0; i < rounds; ++i) {
+            a.splice(a.end(), b); // all n
+            b = a.split_at(16); // all but the first 16
+            b.concat(std::move(a));
+        }
+    });
+    std::cout << "moving " << n << " elements one by one: " << copied << "s, moving them all by splice: "
+              << relinked / rounds / 3 * 1e9 << "ns" << std::endl;
+    EXPECT_EQ(b.size(), n);
+    EXPECT_EQ(*b.begin(), 16LL * rounds % n); // each round rotates the list by 16
+
+    std::mt19937 rng(11);
+    std::vector<int> keys(n);
+    for (int& k : keys) k = rng() % 1000;
+    List<int> ls(keys);
+    double sort = seconds([&] { ls.sort(); });
+    double vector_sort = seconds([&] { std::stable_sort(keys.begin(), keys.end()); });
+    std::cout << "List::sort: " << sort << "s, std::stable_sort on a vector: " << vector_sort << "s" << std::endl;
+    EXPECT_TRUE(ls == List<int>(keys));
+}
+
+TEST(Benchmark, QuickSort) {
+    const size_t n = 1 << 23;
+    std::mt19937_64 rng(5);
+    std::vector<std::pair<std::string, std::vector<int>>> shapes(5);
+    shapes[0].first = "random";
+    shapes[1].first = "sorted";
+    shapes[2].first = "reversed";
+    shapes[3].first = "sawtooth";
+    shapes[4].first = "few unique";
+    for (size_t i = 0; i < n; ++i) {
+        shapes[0].second.push_back(int(rng()));
+        shapes[1].second.push_back(int(i));
+        shapes[2].second.push_back(int(n - i));
+        shapes[3].second.push_back(int(i % 4096));
+        shapes[4].second.push_back(int(rng() % 16));
+    }
+    for (auto& [name, input] : shapes) {
+        auto mine = input, theirs = input;
+        double quick = seconds([&] { sort::quick(mine); });
+        double std_sort = seconds([&] { std::sort(theirs.begin(), theirs.end()); });
+        std::cout << name << " (" << n << " ints): sort::quick " << quick << "s, std::sort " << std_sort << "s" << std::endl;
+        EXPECT_EQ(mine, theirs);
+    }
+}
+
+TEST(Benchmark, RadixSort) {
+    const size_t n = 16 << 20;
+    std::mt19937_64 rng(9);
+    auto race = [&](auto key) {
+        using Key = decltype(key);
+        std::vector<Key> input(n);
+        for (Key& k : input) k = Key(rng());
+        auto lsd = input, msd = input, theirs = input;
+        double radix = seconds([&] { sort::radix(lsd); });
+        double in_place = seconds([&] { sort::radix_in_place(msd); });
+        double std_sort = seconds([&] { std::sort(theirs.begin(), theirs.end()); });
+        std::cout << n << " " << 8 * sizeof(Key) << "-bit keys: sort::radix " << radix << "s, sort::radix_in_place "
+                  << in_place << "s, std::sort " << std_sort << "s" << std::endl;
+        EXPECT_EQ(lsd, theirs);
+        EXPECT_EQ(msd, theirs);
+    };
+    race(uint32_t());
+    race(int64_t());
+    race(float());
+}
@@ -1,6 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <ranges>
+
 #include "graph.hpp"
+#include "graph_file.hpp"
+#include "contraction_hierarchy.hpp"
+#include "disjoint_sets.hpp"
 
 std::vector<int> sort(std::vector<int> arr) { // quick-and-dirty selection sort; will change once we get sorting algorithms implemented
     for (int i = 0; i < arr.size(); ++i) {
@@ -15,6 +24,40 @@ std::vector<int> sort(std::vector<int> arr) { // quick-and-dirty selection sort;
     return arr;
 }
 
+CsrGraph<int> random_graph(int n, int m, unsigned seed, bool integer_weights = false) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> node(0, n - 1);
+    std::uniform_real_distribution<double> weight(0, 10);
+    Graph<int> g;
+    for (int i = 0; i < n; ++i) g.clear_node(i);
+    for (int i = 0; i < m; ++i) {
+        double w = weight(rng);
+        g.update_edge(node(rng), node(rng), integer_weights ? std::floor(w) : w);
+    }
+    return g.freeze();
+}
+
+std::vector<std::tuple<uint32_t, uint32_t, double>> id_edges(const CsrGraph<int>& g) {
+    std::vector<std::tuple<uint32_t, uint32_t, double>> ret;
+    for (uint32_t u = 0; u < g.size(); ++u) {
+        for (size_t i = 0; i < g.degree(u); ++i) ret.push_back({u, g.targets(u)[i], g.weights(u)[i]});
+    }
+    return ret;
+}
+
+std::vector<double> reference_distances(const CsrGraph<int>& g, uint32_t source) { // plain Bellman-Ford
+    std::vector<double> dist(g.size(), std::numeric_limits<double>::infinity());
+    dist[source] = 0;
+    for (size_t round = 0; round < g.size(); ++round) {
+        for (uint32_t u = 0; u < g.size(); ++u) {
+            for (size_t i = 0; i < g.degree(u); ++i) {
+                dist[g.targets(u)[i]] = std::min(dist[g.targets(u)[i]], dist[u] + g.weights(u)[i]);
+            }
+        }
+    }
+    return dist;
+}
+
 TEST(GraphTest, InsertionAndDeletion) {
     Graph<int> g;
     g.clear_node(1);
@@ -28,4 +71,691 @@ TEST(GraphTest, InsertionAndDeletion) {
     EXPECT_EQ(g.edges(), expected_edges);
 }
 
+TEST(GraphTest, BulkLoad) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> node(0, 199);
+    std::uniform_real_distribution<double> weight(0, 10);
+    std::vector<std::tuple<int, int, double>> batch(3000);
+    for (auto& edge : batch) edge = {node(rng), node(rng), weight(rng)};
+    for (size_t threads : {1, 4}) {
+        parallel::ThreadPool pool(threads);
+        Graph<int> loaded, expected;
+        for (int i = 0; i < 200; ++i) {
+            loaded.clear_node(i);
+            expected.clear_node(i);
+        }
+        for (int i = 0; i < 100; ++i) { // some edges exist beforehand and get reweighted
+            loaded.update_edge(i, i + 1, -1);
+            expected.update_edge(i, i + 1, -1);
+        }
+        loaded.bulk_load(batch, pool);
+        for (const auto& [begin, end, w] : batch) expected.update_edge(begin, end, w);
+        EXPECT_EQ(loaded.edge_count(), expected.edge_count());
+        auto a = loaded.edges(), b = expected.edges();
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        EXPECT_EQ(a, b);
+
+        std::vector<std::tuple<int, int, double>> bad = {{0, 1, 1}, {0, 500, 1}};
+        EXPECT_THROW(loaded.bulk_load(bad, pool);, NonexistentNode);
+        EXPECT_EQ(loaded.edge_count(), expected.edge_count());
+
+        for (int i = 0; i < 200; i += 3) loaded.del_node(i);
+        for (int i = 0; i < 200; i += 7) loaded.clear_node(i);
+        size_t count = 0;
+        for (uint32_t u : loaded.nodes() | std::views::transform([&](int key) { return loaded.index().id(key); })) {
+            count += loaded.targets(u).size();
+            for (uint32_t v : loaded.targets(u)) EXPECT_EQ(std::ranges::count(loaded.sources(v), u), 1);
+            for (uint32_t w : loaded.sources(u)) EXPECT_EQ(std::ranges::count(loaded.targets(w), u), 1);
+        }
+        EXPECT_EQ(count, loaded.edge_count());
+        for (const auto& [begin, end, w] : loaded.edges()) {
+            EXPECT_TRUE(begin % 3 != 0 && end % 3 != 0);
+            if (begin % 7 != 0) {
+                EXPECT_DOUBLE_EQ(w, expected.weight(begin, end));
+            }
+        }
+    }
+}
+
+TEST(GraphTest, NodeIndex) {
+    NodeIndex<std::string> index;
+    EXPECT_EQ(index.insert("x"), std::make_pair(0u, true));
+    EXPECT_EQ(index.insert("y"), std::make_pair(1u, true));
+    EXPECT_EQ(index.insert("x"), std::make_pair(0u, false));
+    EXPECT_EQ(index.find("z"), NO_NODE);
+    EXPECT_THROW(index.id("z");, NonexistentNode);
+    EXPECT_EQ(index.erase("x"), 0);
+    EXPECT_FALSE(index.live(0));
+    std::vector<uint32_t> remap;
+    NodeIndex<std::string> dense = index.compacted(remap);
+    EXPECT_EQ(remap, std::vector<uint32_t>({NO_NODE, 0}));
+    EXPECT_EQ(dense.key(0), "y");
+    EXPECT_EQ(index.insert("z"), std::make_pair(0u, true)); // reuses the freed id
+    EXPECT_EQ(index.key(0), "z");
+    EXPECT_EQ(index.size(), 2);
+
+    Graph<std::string> g;
+    for (auto node : {"a", "b", "c"}) g.clear_node(node);
+    g.update_edge("a", "b", 1);
+    g.update_edge("c", "b", 2);
+    g.update_edge("b", "c", 3);
+    g.update_edge("a", "b", 4); // overwrite
+    EXPECT_EQ(g.edge_count(), 3);
+    g.del_node("b");
+    EXPECT_EQ(g.edge_count(), 0);
+    EXPECT_THROW(g.weight("a", "b");, NonexistentNode);
+    g.clear_node("d"); // takes b's old id
+    g.update_edge("d", "a", 5);
+    g.update_edge("c", "d", 6);
+    CsrGraph<std::string> csr = g.freeze();
+    EXPECT_EQ(csr.size(), 3);
+    EXPECT_DOUBLE_EQ(csr.weight("c", "d"), 6);
+    EXPECT_EQ(csr.key(csr.targets(csr.id("d"))[0]), "a");
+    g.del_edge("c", "d");
+    EXPECT_THROW(g.del_edge("c", "d");, NonexistentEdge);
+    EXPECT_EQ(g.edge_count(), 1);
+}
+
+TEST(GraphTest, Freeze) {
+    Graph<std::string> g;
+    for (auto node : {"a", "b", "c", "d"}) g.clear_node(node);
+    g.update_edge("a", "b", 1);
+    g.update_edge("a", "c", 2.5);
+    g.update_edge("c", "a", -1);
+    g.update_edge("c", "d", 4);
+    CsrGraph<std::string> csr = g.freeze();
+    EXPECT_EQ(csr.size(), 4);
+    EXPECT_EQ(csr.edge_count(), 4);
+    EXPECT_DOUBLE_EQ(csr.weight("a", "c"), 2.5);
+    EXPECT_DOUBLE_EQ(csr.weight("c", "a"), -1);
+    EXPECT_THROW(csr.weight("b", "a");, NonexistentEdge);
+    EXPECT_THROW(csr.weight("a", "e");, NonexistentNode);
+    EXPECT_EQ(csr.nodes(), g.nodes());
+    auto edges = csr.edges(), expected_edges = g.edges();
+    std::sort(edges.begin(), edges.end());
+    std::sort(expected_edges.begin(), expected_edges.end());
+    EXPECT_EQ(edges, expected_edges);
+    EXPECT_EQ(csr.degree(csr.id("a")), 2);
+    EXPECT_EQ(csr.key(csr.targets(csr.id("c"))[0]), csr.id("a") < csr.id("d") ? "a" : "d");
+
+    CsrGraph<std::string> reversed = csr.transpose();
+    EXPECT_DOUBLE_EQ(reversed.weight("d", "c"), 4);
+    EXPECT_EQ(reversed.degree(reversed.id("a")), 1);
+}
+
+TEST(GraphTest, FileRoundTrip) {
+    std::string path = (std::filesystem::temp_directory_path() / "graph_file_test.csr").string();
+    CsrGraph<int> g = random_graph(300, 2000, 21);
+    write_csr(g, path);
+    {
+        CsrGraph<int> mapped = open_csr<int>(path);
+        EXPECT_EQ(mapped.nodes(), g.nodes());
+        EXPECT_EQ(mapped.edges(), g.edges());
+        EXPECT_EQ(mapped.id(g.key(7)), 7);
+        EXPECT_EQ(dijkstra(mapped, 0).dist, dijkstra(g, 0).dist);
+        EXPECT_EQ(strongly_connected_components(mapped.transpose()).count, strongly_connected_components(g).count);
+    }
+    Graph<int> small;
+    small.clear_node(5);
+    small.clear_node(9);
+    small.update_edge(9, 5, 2.5);
+    write_csr(small, path);
+    CsrGraph<int> mapped = open_csr<int>(path);
+    EXPECT_DOUBLE_EQ(mapped.weight(9, 5), 2.5);
+    EXPECT_THROW(open_csr<long long>(path);, BadGraphFile);
+    std::ofstream(path, std::ios::binary | std::ios::app) << "trailing garbage";
+    EXPECT_THROW(open_csr<int>(path);, BadGraphFile);
+    std::filesystem::remove(path);
+    EXPECT_THROW(open_csr<int>(path);, std::system_error);
+}
+
+TEST(GraphTest, FileStringKeys) {
+    std::string path = (std::filesystem::temp_directory_path() / "graph_file_strings.csr").string();
+    Graph<std::string> g;
+    for (int i = 0; i < 7; ++i) g.clear_node(std::string(i, 'x')); // including the empty key
+    for (int i = 0; i < 200; ++i) {
+        g.clear_node("node " + std::to_string(i));
+        g.update_edge("node " + std::to_string(i), std::string(i % 7, 'x'), i);
+    }
+    write_csr(g, path);
+    CsrGraph<std::string> expected = g.freeze();
+    {
+        CsrGraph<std::string_view> mapped = open_csr<std::string_view>(path);
+        ASSERT_EQ(mapped.size(), expected.size());
+        for (uint32_t u = 0; u < mapped.size(); ++u) EXPECT_EQ(mapped.key(u), expected.key(u));
+        EXPECT_DOUBLE_EQ(mapped.weight("node 8", "x"), 8);
+        EXPECT_EQ(mapped.degree(mapped.id("")), 0);
+        EXPECT_EQ(dijkstra(mapped, mapped.id("node 3")).dist, dijkstra(expected, expected.id("node 3")).dist);
+    }
+    CsrGraph<std::string> copied = open_csr<std::string>(path);
+    EXPECT_EQ(copied.edges(), expected.edges());
+    EXPECT_THROW(open_csr<int>(path);, BadGraphFile);
+    write_csr(CsrGraph<int>(std::vector<int>{1, 2}), path);
+    EXPECT_THROW(open_csr<std::string>(path);, BadGraphFile);
+    std::filesystem::remove(path);
+}
+
+TEST(GraphTest, Dijkstra) {
+    Graph<char> g;
+    for (char c = 'a'; c <= 'e'; ++c) g.clear_node(c);
+    g.update_edge('a', 'b', 4);
+    g.update_edge('a', 'c', 1);
+    g.update_edge('c', 'b', 2);
+    g.update_edge('b', 'd', 5);
+    g.update_edge('c', 'd', 8);
+    CsrGraph<char> csr = g.freeze();
+    ShortestPaths sp = dijkstra(csr, csr.id('a'));
+    EXPECT_DOUBLE_EQ(sp.dist[csr.id('d')], 8);
+    EXPECT_FALSE(sp.reached(csr.id('e')));
+    std::vector<char> path;
+    for (uint32_t n : sp.path(csr.id('d'))) path.push_back(csr.key(n));
+    EXPECT_EQ(path, std::vector<char>({'a', 'c', 'b', 'd'}));
+    EXPECT_TRUE(sp.path(csr.id('e')).empty());
+
+    g.update_edge('d', 'e', -1);
+    EXPECT_THROW(dijkstra(g.freeze(), csr.id('a'));, NegativeWeight);
+
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        CsrGraph<int> r = random_graph(200, 1000, seed, true);
+        std::vector<double> expected = reference_distances(r, 0);
+        EXPECT_EQ(dijkstra<BinaryHeap>(r, 0).dist, expected);
+        EXPECT_EQ(dijkstra<DaryHeap<4>>(r, 0).dist, expected);
+        EXPECT_EQ(dijkstra<PairingHeap>(r, 0).dist, expected);
+        EXPECT_EQ(dijkstra<RadixHeap>(r, 0).dist, expected);
+        ShortestPaths sp = dijkstra<PairingHeap>(r, 0);
+        for (uint32_t v = 1; v < r.size(); ++v) { // predecessors lie on a shortest path
+            if (!sp.reached(v)) continue;
+            EXPECT_DOUBLE_EQ(sp.dist[v], sp.dist[sp.pred[v]] + r.weights()[r.find_edge(sp.pred[v], v)]);
+        }
+    }
+}
+
+bool valid_route(const CsrGraph<int>& g, const Route& route, uint32_t source, uint32_t target) {
+    if (route.path.front() != source || route.path.back() != target) return false;
+    double length = 0;
+    for (size_t i = 0; i + 1 < route.path.size(); ++i) {
+        size_t e = g.find_edge(route.path[i], route.path[i + 1]);
+        if (e == g.edge_count()) return false;
+        length += g.weights()[e];
+    }
+    return std::abs(length - route.dist) < 1e-9;
+}
+
+TEST(GraphTest, PointToPoint) {
+    CsrGraph<int> g = random_graph(400, 1500, 13);
+    CsrGraph<int> reverse = g.transpose();
+    std::vector<ShortestPaths> full;
+    for (uint32_t s = 0; s < 20; ++s) full.push_back(dijkstra(g, s));
+    parallel::ThreadPool pool(4);
+    parallel::for_each(0, 20 * 400, [&](size_t i) { // every thread reuses its own scratch across queries
+        uint32_t s = i / 400, t = i % 400;
+        Route both = bidirectional_dijkstra(g, reverse, s, t);
+        Route guided = astar(g, s, t, [](uint32_t) { return 0.0; });
+        EXPECT_EQ(both.reached(), full[s].reached(t));
+        EXPECT_EQ(guided.reached(), full[s].reached(t));
+        if (!full[s].reached(t)) return;
+        EXPECT_NEAR(both.dist, full[s].dist[t], 1e-9);
+        EXPECT_NEAR(guided.dist, full[s].dist[t], 1e-9);
+        EXPECT_TRUE(valid_route(g, both, s, t));
+        EXPECT_TRUE(valid_route(g, guided, s, t));
+    }, pool, 64);
+
+    // A grid whose edge weights are at least the Euclidean distance, so straight-line distance is admissible
+    const int side = 30;
+    std::mt19937 rng(14);
+    std::uniform_real_distribution<double> detour(1, 3);
+    std::vector<int> keys(side * side);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges;
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            if (c + 1 < side) edges.push_back({r * side + c, r * side + c + 1, detour(rng)});
+            if (c + 1 < side) edges.push_back({r * side + c + 1, r * side + c, detour(rng)});
+            if (r + 1 < side) edges.push_back({r * side + c, (r + 1) * side + c, detour(rng)});
+            if (r + 1 < side) edges.push_back({(r + 1) * side + c, r * side + c, detour(rng)});
+        }
+    }
+    CsrGraph<int> grid(keys, edges);
+    uint32_t target = side * side - 1;
+    auto straight_line = [&](uint32_t v) { return std::hypot(int(v / side) - side + 1, int(v % side) - side + 1); };
+    Route route = astar(grid, 0, target, straight_line);
+    EXPECT_NEAR(route.dist, dijkstra(grid, 0).dist[target], 1e-9);
+    EXPECT_TRUE(valid_route(grid, route, 0, target));
+    EXPECT_NEAR(bidirectional_dijkstra(grid, grid.transpose(), 0, target).dist, route.dist, 1e-9);
+    EXPECT_EQ(astar(grid, 5, 5, straight_line).path, std::vector<uint32_t>({5}));
+    EXPECT_THROW(bidirectional_dijkstra(g, reverse, 0, 400);, NonexistentNode);
+}
+
+TEST(GraphTest, ContractionHierarchy) {
+    std::string path = (std::filesystem::temp_directory_path() / "contraction_hierarchy_test.ch").string();
+    for (size_t threads : {1, 4}) {
+        parallel::ThreadPool pool(threads);
+        CsrGraph<int> g = random_graph(300, 1000, 15 + threads, threads == 1);
+        ContractionHierarchy ch(g, pool);
+        std::vector<uint32_t> ranks;
+        for (uint32_t v = 0; v < g.size(); ++v) ranks.push_back(ch.rank(v));
+        std::sort(ranks.begin(), ranks.end());
+        for (uint32_t v = 0; v < g.size(); ++v) EXPECT_EQ(ranks[v], v);
+
+        ch.save(path);
+        ContractionHierarchy mapped = ContractionHierarchy::open(path);
+        EXPECT_EQ(mapped.arc_count(), ch.arc_count());
+        for (uint32_t s = 0; s < g.size(); s += 7) {
+            ShortestPaths full = dijkstra(g, s);
+            for (uint32_t t = 0; t < g.size(); ++t) {
+                Route route = (t % 2 ? mapped : ch).route(s, t);
+                EXPECT_EQ(route.reached(), full.reached(t));
+                if (!full.reached(t)) {
+                    EXPECT_EQ(ch.distance(s, t), std::numeric_limits<double>::infinity());
+                    continue;
+                }
+                EXPECT_NEAR(ch.distance(s, t), full.dist[t], 1e-9);
+                EXPECT_NEAR(route.dist, full.dist[t], 1e-9);
+                EXPECT_TRUE(valid_route(g, route, s, t));
+            }
+        }
+    }
+    std::ofstream(path, std::ios::binary | std::ios::app) << "x";
+    EXPECT_THROW(ContractionHierarchy::open(path);, BadGraphFile);
+    std::filesystem::remove(path);
+}
+
+TEST(GraphTest, DeltaStepping) {
+    parallel::ThreadPool one(1), three(3);
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        CsrGraph<int> r = random_graph(300, 2000, seed);
+        std::vector<double> expected = dijkstra(r, 0).dist;
+        for (double delta : {0.0, 0.1, 2.0, 100.0}) {
+            for (auto* pool : {&one, &three}) {
+                ShortestPaths sp = delta_stepping(r, 0, delta, *pool);
+                EXPECT_EQ(sp.dist, expected);
+                for (uint32_t v = 1; v < r.size(); ++v) {
+                    if (!sp.reached(v)) continue;
+                    EXPECT_DOUBLE_EQ(sp.dist[v], sp.dist[sp.pred[v]] + r.weights()[r.find_edge(sp.pred[v], v)]);
+                }
+            }
+        }
+    }
+
+    // A delta far below the weights, and one weight so large that dist / delta overflows: buckets must stay sparse.
+    CsrGraph<int> r = random_graph(300, 2000, 9);
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges;
+    for (uint32_t u = 0; u < r.size(); ++u) {
+        for (size_t e = r.offsets()[u]; e < r.offsets()[u + 1]; ++e) edges.emplace_back(u, r.targets()[e], r.weights()[e] * 1e6);
+    }
+    edges.emplace_back(0, r.size(), 1e300); // a node reached only through the huge edge
+    edges.emplace_back(r.size(), 1, 1.0);
+    std::vector<int> keys(r.size() + 1);
+    std::iota(keys.begin(), keys.end(), 0);
+    CsrGraph<int> wide(keys, edges);
+    std::vector<double> expected = dijkstra(wide, 0).dist;
+    EXPECT_EQ(expected.back(), 1e300);
+    for (double delta : {1e-3, 1e-300}) {
+        for (auto* pool : {&one, &three}) EXPECT_EQ(delta_stepping(wide, 0, delta, *pool).dist, expected);
+    }
+}
+
+TEST(GraphTest, DynamicShortestPaths) {
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> node(0, 149);
+    std::uniform_real_distribution<double> weight(0, 10);
+    Graph<int> g;
+    for (int i = 0; i < 150; ++i) g.clear_node(i);
+    for (int i = 0; i < 500; ++i) g.update_edge(node(rng), node(rng), std::floor(weight(rng)));
+    DynamicShortestPaths<int> sp(g, 0);
+    EXPECT_THROW(sp.update_edge(1, 2, -1);, NegativeWeight);
+    EXPECT_THROW(sp.del_node(0);, std::invalid_argument);
+    auto check = [&] {
+        CsrGraph<int> frozen = g.freeze();
+        ShortestPaths expected = dijkstra(frozen, frozen.id(0));
+        for (uint32_t v = 0; v < frozen.size(); ++v) EXPECT_EQ(sp.distance(frozen.key(v)), expected.dist[v]);
+        for (int key : g.nodes()) { // the tree is made of real edges and agrees with the distances
+            uint32_t id = g.index().id(key), pred = sp.preds()[id];
+            if (pred == NO_NODE) continue;
+            EXPECT_EQ(sp.distances()[id], sp.distances()[pred] + g.weight(g.index().key(pred), key));
+        }
+    };
+    check();
+    for (int batch = 0; batch < 30; ++batch) {
+        for (int i = 0; i < 10; ++i) {
+            int a = node(rng), b = node(rng);
+            if (!g.contains(a) || !g.contains(b)) continue;
+            switch (rng() % 8) {
+            case 0: if (a != 0) sp.del_node(a); break;
+            case 1: sp.clear_node(a); break;
+            case 2: sp.clear_node(a + 1000); break; // may reuse a freed id
+            default:
+                try {
+                    if (rng() % 2) sp.del_edge(a, b);
+                    else sp.update_edge(a, b, std::floor(weight(rng)));
+                } catch (const NonexistentEdge&) {
+                    sp.update_edge(a, b, std::floor(weight(rng)));
+                }
+            }
+        }
+        if (batch % 10 == 0) {
+            sp.clear_node(batch + 2000);
+            sp.update_edge(0, batch + 2000, 0.5);
+        }
+        sp.repair();
+        EXPECT_FALSE(sp.pending());
+        check();
+    }
+
+    Graph<int> chain;
+    for (int i = 0; i < 4; ++i) chain.clear_node(i);
+    chain.update_edge(0, 1, 1);
+    chain.update_edge(1, 2, 1);
+    chain.update_edge(2, 3, 1);
+    DynamicShortestPaths<int> cut(chain, 0);
+    cut.del_edge(1, 2);
+    cut.clear_node(2); // 2 now has no edges at all, while its in-edge's deletion is still pending
+    EXPECT_EQ(cut.repair(), 2); // 2 and 3
+    EXPECT_EQ(cut.distance(2), std::numeric_limits<double>::infinity());
+    EXPECT_EQ(cut.distance(3), std::numeric_limits<double>::infinity());
+    EXPECT_EQ(cut.preds()[chain.index().id(3)], NO_NODE);
+}
+
+TEST(GraphTest, BreadthFirst) {
+    parallel::ThreadPool one(1), three(3);
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        CsrGraph<int> r = random_graph(2000, 3000 + 4000 * seed, seed);
+        std::vector<uint32_t> expected(r.size(), NO_NODE); // plain queue BFS
+        std::queue<uint32_t> q;
+        expected[0] = 0;
+        for (q.push(0); !q.empty(); q.pop()) {
+            for (uint32_t v : r.targets(q.front())) {
+                if (expected[v] == NO_NODE) {
+                    expected[v] = expected[q.front()] + 1;
+                    q.push(v);
+                }
+            }
+        }
+        for (auto* pool : {&one, &three}) {
+            BfsTree tree = bfs(r, 0, NO_NODE, *pool);
+            EXPECT_EQ(tree.hops, expected);
+            for (uint32_t v = 1; v < r.size(); ++v) {
+                if (!tree.reached(v)) continue;
+                EXPECT_EQ(tree.hops[tree.parent[v]] + 1, tree.hops[v]);
+                EXPECT_NE(r.find_edge(tree.parent[v], v), r.edge_count());
+            }
+            BfsTree near = bfs(r, 0, 2, *pool);
+            for (uint32_t v = 0; v < r.size(); ++v) EXPECT_EQ(near.hops[v], expected[v] <= 2 ? expected[v] : NO_NODE);
+        }
+    }
+    Graph<int> line;
+    for (int i = 0; i < 4; ++i) line.clear_node(i);
+    for (int i = 0; i < 3; ++i) line.update_edge(i, i + 1, 1);
+    CsrGraph<int> csr = line.freeze();
+    BfsTree tree = bfs(csr, csr.id(0));
+    EXPECT_EQ(tree.path(csr.id(3)).size(), 4);
+    EXPECT_EQ(tree.hops[csr.id(3)], 3);
+}
+
+TEST(GraphTest, MaxFlow) {
+    FlowNetwork<int> clrs(6);
+    std::vector<std::tuple<uint32_t, uint32_t, int>> edges = {
+        {0, 1, 16}, {0, 2, 13}, {1, 3, 12}, {2, 1, 4}, {2, 4, 14}, {3, 2, 9}, {3, 5, 20}, {4, 3, 7}, {4, 5, 4}};
+    for (auto [u, v, c] : edges) clrs.add_edge(u, v, c);
+    EXPECT_EQ(clrs.dinic(0, 5), 23);
+    EXPECT_EQ(clrs.cut_edges(0), std::vector<size_t>({2, 7, 8}));
+    clrs.reset();
+    EXPECT_EQ(clrs.push_relabel(0, 5), 23);
+    EXPECT_EQ(clrs.cut_edges(0), std::vector<size_t>({2, 7, 8}));
+    EXPECT_THROW(clrs.dinic(0, 0);, std::invalid_argument);
+    EXPECT_THROW(clrs.add_edge(0, 6, 1);, NonexistentNode);
+
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        CsrGraph<int> r = random_graph(100, 600, seed, true);
+        FlowNetwork<long long> a(r.size()), b(r.size());
+        for (uint32_t u = 0; u < r.size(); ++u) {
+            for (size_t i = 0; i < r.degree(u); ++i) {
+                a.add_edge(u, r.targets(u)[i], r.weights(u)[i]);
+                b.add_edge(u, r.targets(u)[i], r.weights(u)[i]);
+            }
+        }
+        long long expected = a.dinic(0, 99);
+        EXPECT_EQ(b.push_relabel(0, 99), expected);
+        for (auto* net : {&a, &b}) {
+            std::vector<long long> balance(r.size(), 0);
+            for (size_t e = 0; e < net->edge_count(); ++e) {
+                EXPECT_LE(0, net->flow(e));
+                EXPECT_LE(net->flow(e), net->capacity(e));
+            }
+            size_t e = 0;
+            for (uint32_t u = 0; u < r.size(); ++u) {
+                for (uint32_t v : r.targets(u)) {
+                    balance[u] -= net->flow(e);
+                    balance[v] += net->flow(e++);
+                }
+            }
+            for (uint32_t u = 1; u < 99; ++u) EXPECT_EQ(balance[u], 0);
+            EXPECT_EQ(balance[99], expected);
+            long long cut_capacity = 0;
+            for (size_t e : net->cut_edges(0)) cut_capacity += net->capacity(e);
+            EXPECT_EQ(cut_capacity, expected);
+        }
+        FlowNetwork<double> from_graph(r);
+        EXPECT_DOUBLE_EQ(from_graph.push_relabel(0, 99), expected);
+    }
+}
+
+bool same_partition(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::unordered_map<uint32_t, uint32_t> forward, backward;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (forward.emplace(a[i], b[i]).first->second != b[i]) return false;
+        if (backward.emplace(b[i], a[i]).first->second != a[i]) return false;
+    }
+    return true;
+}
+
+TEST(GraphTest, StronglyConnectedComponents) {
+    Graph<int> g;
+    for (int i = 0; i < 8; ++i) g.clear_node(i);
+    for (auto [u, v] : std::vector<std::pair<int, int>>{{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4}, {4, 3}, {5, 6}, {6, 5}, {6, 4}, {7, 7}}) {
+        g.update_edge(u, v, 1);
+    }
+    CsrGraph<int> csr = g.freeze();
+    Components c = strongly_connected_components(csr);
+    EXPECT_EQ(c.count, 4);
+    EXPECT_EQ(c.component[csr.id(0)], c.component[csr.id(2)]);
+    EXPECT_EQ(c.component[csr.id(3)], c.component[csr.id(4)]);
+    EXPECT_NE(c.component[csr.id(2)], c.component[csr.id(3)]);
+    CsrGraph<uint32_t> dag = condense(csr, c);
+    EXPECT_EQ(dag.edge_count(), 2);
+    for (auto [from, to, w] : dag.edges()) EXPECT_GT(from, to); // reverse topological ids
+
+    TarjanSCC tarjan; // reused across runs
+    parallel::ThreadPool one(1), three(3);
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        CsrGraph<int> r = random_graph(300, 250 + 60 * seed, seed);
+        std::vector<std::vector<bool>> reaches(r.size()); // reference: mutual reachability
+        for (uint32_t u = 0; u < r.size(); ++u) {
+            BfsTree tree = bfs(r, u);
+            for (uint32_t v = 0; v < r.size(); ++v) reaches[u].push_back(tree.reached(v));
+        }
+        Components expected = tarjan.run(r);
+        for (uint32_t u = 0; u < r.size(); ++u) {
+            for (uint32_t v = 0; v < r.size(); ++v) {
+                EXPECT_EQ(expected.component[u] == expected.component[v], reaches[u][v] && reaches[v][u]);
+            }
+        }
+        for (auto* pool : {&one, &three}) {
+            Components c = parallel_scc(r, r.transpose(), *pool);
+            EXPECT_EQ(c.count, expected.count);
+            EXPECT_TRUE(same_partition(c.component, expected.component));
+        }
+    }
+
+    std::vector<std::tuple<uint32_t, uint32_t, double>> ring; // deep enough to overflow a recursive DFS
+    std::vector<int> keys;
+    for (int i = 0; i < 1000000; ++i) {
+        keys.push_back(i);
+        ring.push_back({i, (i + 1) % 1000000, 1});
+    }
+    EXPECT_EQ(strongly_connected_components(CsrGraph<int>(keys, ring)).count, 1);
+}
+
+TEST(GraphTest, TopologicalSort) {
+    parallel::ThreadPool one(1), three(3);
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        CsrGraph<int> r = random_graph(500, 3000, seed);
+        std::vector<std::tuple<uint32_t, uint32_t, double>> forward; // keep the edges going up in id: a DAG
+        for (auto [u, v, w] : id_edges(r)) {
+            if (u < v) forward.push_back({u, v, w});
+        }
+        CsrGraph<int> dag(r.nodes(), forward);
+        for (auto* pool : {&one, &three}) {
+            size_t streamed = 0;
+            EXPECT_TRUE(topological_levels(dag, [&](std::span<const uint32_t> level) { streamed += level.size(); }, *pool).empty());
+            EXPECT_EQ(streamed, dag.size());
+
+            TopologicalOrder topo = topological_sort(dag, *pool);
+            ASSERT_TRUE(topo.acyclic());
+            std::vector<size_t> level_of(dag.size());
+            for (size_t i = 0; i < topo.levels(); ++i) {
+                for (uint32_t v : topo.level(i)) level_of[v] = i;
+            }
+            std::vector<size_t> deepest_parent(dag.size(), 0);
+            for (uint32_t u = 0; u < dag.size(); ++u) {
+                for (uint32_t v : dag.targets(u)) {
+                    EXPECT_LT(level_of[u], level_of[v]);
+                    deepest_parent[v] = std::max(deepest_parent[v], level_of[u] + 1);
+                }
+            }
+            EXPECT_EQ(level_of, deepest_parent); // each node sits on the earliest level it can
+        }
+        TopologicalOrder cyclic = topological_sort(r, three);
+        ASSERT_FALSE(cyclic.acyclic());
+        for (size_t i = 0; i < cyclic.cycle.size(); ++i) {
+            EXPECT_NE(r.find_edge(cyclic.cycle[i], cyclic.cycle[(i + 1) % cyclic.cycle.size()]), r.edge_count());
+        }
+    }
+}
+
+TEST(GraphTest, MinimumSpanningForest) {
+    Graph<char> g;
+    for (char c = 'a'; c <= 'f'; ++c) g.clear_node(c);
+    g.update_edge('a', 'b', 4);
+    g.update_edge('b', 'c', 1);
+    g.update_edge('c', 'a', 2);
+    g.update_edge('a', 'c', 7);
+    g.update_edge('c', 'c', 0);
+    g.update_edge('d', 'e', 3); // second tree; f stays isolated
+    CsrGraph<char> csr = g.freeze();
+    for (SpanningForest forest : {filter_kruskal(csr), boruvka(csr)}) {
+        EXPECT_DOUBLE_EQ(forest.weight, 6);
+        EXPECT_EQ(forest.edges.size(), 3);
+        for (auto [u, v, w] : forest.edges) EXPECT_DOUBLE_EQ(csr.weight(csr.key(u), csr.key(v)), w);
+    }
+
+    parallel::ThreadPool one(1), three(3);
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        CsrGraph<int> r = random_graph(20000, 40000 + 20000 * seed, seed, seed % 2); // odd seeds have many ties
+        std::vector<std::tuple<double, uint32_t, uint32_t>> sorted; // reference: plain Kruskal
+        for (auto [u, v, w] : id_edges(r)) sorted.push_back({w, u, v});
+        std::sort(sorted.begin(), sorted.end());
+        DisjointSets sets(r.size());
+        double expected = 0;
+        size_t expected_edges = 0;
+        for (auto [w, u, v] : sorted) {
+            if (sets.unite(u, v)) {
+                expected += w;
+                ++expected_edges;
+            }
+        }
+        for (auto* pool : {&one, &three}) {
+            for (SpanningForest forest : {filter_kruskal(r, *pool), boruvka(r, *pool)}) {
+                EXPECT_NEAR(forest.weight, expected, 1e-6);
+                EXPECT_EQ(forest.edges.size(), expected_edges);
+                DisjointSets acyclic(r.size());
+                for (auto [u, v, w] : forest.edges) EXPECT_TRUE(acyclic.unite(u, v));
+            }
+        }
+    }
+}
+
+TEST(GraphTest, BellmanFord) {
+    parallel::ThreadPool three(3);
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        CsrGraph<int> r = random_graph(300, 1500, seed);
+        std::vector<double> potential(r.size()); // reweighting by a potential adds negative edges but no negative cycles
+        std::mt19937 rng(seed);
+        for (double& p : potential) p = std::uniform_real_distribution<double>(0, 20)(rng);
+        std::vector<std::tuple<uint32_t, uint32_t, double>> edges;
+        for (auto [u, v, w] : id_edges(r)) edges.push_back({u, v, w + potential[u] - potential[v]});
+        CsrGraph<int> shifted(r.nodes(), edges);
+        std::vector<double> expected = dijkstra(r, 0).dist;
+        for (ShortestPaths sp : {bellman_ford(shifted, 0, three), spfa(shifted, 0)}) {
+            EXPECT_TRUE(sp.negative_cycle.empty());
+            for (uint32_t v = 0; v < r.size(); ++v) {
+                if (expected[v] == std::numeric_limits<double>::infinity()) EXPECT_FALSE(sp.reached(v));
+                else EXPECT_NEAR(sp.dist[v], expected[v] + potential[0] - potential[v], 1e-9);
+            }
+        }
+
+        edges.push_back({10, 11, -40}); // now close a negative cycle 10 -> 11 -> 12 -> 10 reachable from 0
+        edges.push_back({11, 12, 5});
+        edges.push_back({12, 10, 5});
+        edges.push_back({0, 10, 1});
+        CsrGraph<int> cyclic(r.nodes(), edges);
+        for (ShortestPaths sp : {bellman_ford(cyclic, 0, three), spfa(cyclic, 0)}) {
+            ASSERT_FALSE(sp.negative_cycle.empty());
+            double total = 0;
+            for (size_t i = 0; i < sp.negative_cycle.size(); ++i) {
+                size_t e = cyclic.find_edge(sp.negative_cycle[i], sp.negative_cycle[(i + 1) % sp.negative_cycle.size()]);
+                ASSERT_NE(e, cyclic.edge_count());
+                total += cyclic.weights()[e];
+            }
+            EXPECT_LT(total, 0);
+        }
+    }
+}
+
+size_t bandwidth(const CsrGraph<int>& g) { // widest gap between the ids at the two ends of an edge
+    size_t ret = 0;
+    for (uint32_t u = 0; u < g.size(); ++u) {
+        for (uint32_t v : g.targets(u)) ret = std::max<size_t>(ret, u > v ? u - v : v - u);
+    }
+    return ret;
+}
+
+TEST(GraphTest, Reordering) {
+    const int side = 40; // a grid with scrambled ids, so every ordering has locality to recover
+    std::vector<int> keys(side * side);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<std::tuple<uint32_t, uint32_t, double>> edges;
+    for (int v = 0; v < side * side; ++v) {
+        if (v % side + 1 < side) edges.push_back({v, v + 1, 1 + v % 3});
+        if (v + side < side * side) edges.push_back({v + side, v, 2 + v % 5});
+    }
+    CsrGraph<int> grid(keys, edges);
+    std::vector<uint32_t> shuffle(grid.size());
+    std::iota(shuffle.begin(), shuffle.end(), 0);
+    std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(16));
+    parallel::ThreadPool pool(4);
+    CsrGraph<int> scrambled = relabel(grid, shuffle, pool);
+    EXPECT_GT(bandwidth(scrambled), grid.size() / 2);
+
+    for (const auto& perm : {reverse_cuthill_mckee(scrambled), bfs_order(scrambled), degree_order(scrambled)}) {
+        std::vector<uint32_t> sorted = perm;
+        std::sort(sorted.begin(), sorted.end());
+        for (uint32_t i = 0; i < sorted.size(); ++i) EXPECT_EQ(sorted[i], i);
+        CsrGraph<int> r = relabel(scrambled, perm, pool);
+        auto a = r.edges(), b = grid.edges();
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        EXPECT_EQ(a, b);
+        ShortestPaths before = dijkstra(scrambled, scrambled.id(0)), after = dijkstra(r, r.id(0));
+        for (uint32_t v = 0; v < r.size(); ++v) EXPECT_EQ(after.dist[r.id(r.key(v))], before.dist[scrambled.id(r.key(v))]);
+    }
+    EXPECT_LE(bandwidth(relabel(scrambled, reverse_cuthill_mckee(scrambled))), 2 * side);
+    EXPECT_LE(bandwidth(relabel(scrambled, bfs_order(scrambled))), 2 * side);
+
+    CsrGraph<int> star({0, 1, 2, 3}, {{1, 2, 1}, {1, 3, 1}, {0, 1, 1}, {3, 2, 1}});
+    EXPECT_EQ(degree_order(star), std::vector<uint32_t>({3, 0, 1, 2}));
+    EXPECT_THROW(relabel(star, {0, 1, 1, 2});, std::invalid_argument);
+}
+
 // The rest are algorithms (Dijkstra, Prim, etc): the tests should be in this file; the algorithms should be functions in include/graph.hpp
\ No newline at end of file
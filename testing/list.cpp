@@ -2,10 +2,14 @@
 #include <cstdlib>
 #include <vector>
 #include <iostream>
+#include <random>
+#include <string>
 
 #include <gtest/gtest.h>
 
 #include "list.hpp"
+#include "unrolled_list.hpp"
+#include "indexed_list.hpp"
 
 
 class LinkedListTest : public testing::Test {
@@ -60,4 +64,276 @@ TEST_F(LinkedListTest, ApplyAndReduce) {
     EXPECT_EQ(ls.reduce([](int a, int b) -> int { return a * b; }, 1), 3628800);
     ls.apply([](int n) -> int { return n * n; });
     EXPECT_EQ(ls.string(), "{1, 4, 9, 16, 25, 36, 49, 64, 81, 100}");
-}
\ No newline at end of file
+}
+TEST_F(LinkedListTest, Pool) {
+    auto* freed = ls.begin().node();
+    ls.popl();
+    ls.pushr(21);
+    EXPECT_EQ(ls.back().node(), freed); // the freed node is handed out again
+    EXPECT_EQ(ls.string(), "{2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21}");
+
+    List<int> shared(ls.pool());
+    shared.pushr(1);
+    EXPECT_TRUE(shared.pool() == ls.pool());
+    ls.clear(); // shared still has nodes in the slabs, so they must stay
+    EXPECT_EQ(shared.string(), "{1}");
+    EXPECT_GT(shared.pool().slab_count(), 0);
+
+    List<std::string> strings = {"a", "b", "c"};
+    strings.del_vals("b");
+    strings.popl();
+    strings.popl();
+    EXPECT_TRUE(strings.is_empty());
+    strings.pushl("d");
+    EXPECT_EQ(strings.string(), "{d}");
+
+    List<std::string, HeapNodes<ListNode<std::string>>> heap = {"x", "y"};
+    heap.del(0);
+    EXPECT_EQ(heap.string(), "{y}");
+}
+
+// The interface all three lists share, run against each. The block lists get small blocks of a dozen or so
+// ints, so these edits split and merge blocks.
+struct PlainList { template <typename T> using type = List<T>; };
+struct SmallUnrolled { template <typename T> using type = UnrolledList<T, 64>; };
+struct SmallIndexed { template <typename T> using type = IndexedList<T, 64>; };
+
+template <typename Kind>
+class ListKindTest : public testing::Test {};
+using ListKinds = testing::Types<PlainList, SmallUnrolled, SmallIndexed>;
+TYPED_TEST_SUITE(ListKindTest, ListKinds);
+
+TYPED_TEST(ListKindTest, Sequence) {
+    using Ints = typename TypeParam::template type<int>;
+    Ints ls([](size_t n) -> int { return n + 1; }, 20);
+    EXPECT_EQ(ls.string(), "{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20}");
+    ls.popl();
+    ls.popr();
+    ls.pushl(20);
+    ls.pushr(1);
+    ls.insert(2, 5);
+    ls.insert(-17, 23);
+    ls.insert(18, 43);
+    ls.insert(-4, 22);
+    ls.del(1);
+    ls.del(16);
+    ls.del(-2);
+    ls.del(-18);
+    ls[3] = 23;
+    EXPECT_EQ(ls[-3], 22);
+    EXPECT_EQ(ls.string(), "{20, 5, 3, 23, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 43, 17, 22, 18, 1}");
+    EXPECT_THROW(ls[20], ListOutOfBounds);
+    EXPECT_THROW(ls[-21], ListOutOfBounds);
+
+    std::mt19937 rng(5);
+    std::vector<int> expected;
+    Ints random;
+    for (int i = 0; i < 2000; ++i) {
+        if (expected.empty() || rng() % 3) {
+            size_t pos = rng() % (expected.size() + 1);
+            expected.insert(expected.begin() + pos, i);
+            random.insert(pos, i);
+        } else {
+            size_t pos = rng() % expected.size();
+            expected.erase(expected.begin() + pos);
+            random.del(pos);
+        }
+    }
+    EXPECT_TRUE(random == Ints(expected));
+
+    Ints mod([](size_t n) -> int { return (n + 1) % 4; }, 20);
+    EXPECT_EQ(mod.find_vals(3), std::vector<size_t>({2, 6, 10, 14, 18}));
+    mod.del_vals(2);
+    EXPECT_EQ(mod.string(), "{1, 3, 0, 1, 3, 0, 1, 3, 0, 1, 3, 0, 1, 3, 0}");
+    EXPECT_EQ(mod.reduce([](int a, int b) -> int { return a + b; }), 20);
+    mod.apply([](int n) -> int { return n * n; });
+    EXPECT_EQ(mod.reduce([](int a, int b) -> int { return a + b; }), 50);
+
+    typename TypeParam::template type<std::string> strings = {"a", "b", "c", "d"};
+    strings.insert(1, strings[3]); // the value lives in the list being edited
+    strings.del_vals("c");
+    EXPECT_EQ(strings.string(), "{a, d, b, d}");
+    EXPECT_EQ(strings.find_vals("d"), std::vector<size_t>({1, 3}));
+}
+
+TEST_F(LinkedListTest, Unrolled) {
+    using Small = UnrolledList<int, 64>;
+    Small us;
+    for (int i = 0; i < 1000; ++i) us.pushr(i);
+    EXPECT_EQ(us.block_count(), (1000 + Small::CAPACITY - 1) / Small::CAPACITY); // pushr leaves blocks full
+    for (int i = 0; i < 500; ++i) us.del(i); // every other element, so blocks fall below half and merge
+    EXPECT_EQ(us.size(), 500);
+    EXPECT_EQ(us[0], 1);
+    EXPECT_EQ(us[-1], 999);
+    EXPECT_LE(us.block_count(), 2 * us.size() / Small::CAPACITY + 1);
+}
+
+TEST_F(LinkedListTest, Indexed) {
+    using Small = IndexedList<int, 64>;
+    std::mt19937 rng(6);
+    std::vector<int> expected;
+    Small random;
+    for (int i = 0; i < 5000; ++i) {
+        if (expected.empty() || rng() % 5 < 3) {
+            size_t pos = rng() % (expected.size() + 1);
+            expected.insert(expected.begin() + pos, i);
+            random.insert(pos, i);
+        } else {
+            size_t pos = rng() % expected.size();
+            expected.erase(expected.begin() + pos);
+            random.del(pos);
+        }
+        if (i % 500 == 0) { // del_vals rebuilds the skip links
+            random.del_vals(i / 2);
+            std::erase(expected, i / 2);
+        }
+    }
+    ASSERT_EQ(random.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) ASSERT_EQ(random[i], expected[i]);
+    while (!random.is_empty()) random.popl();
+    random.pushl(1);
+    random.insert(1, 2);
+    EXPECT_EQ(random.string(), "{1, 2}");
+}
+
+struct Counted { // counts the element copies and moves a list makes
+    static inline int copies = 0, moves = 0;
+    int v;
+    Counted(int v) : v(v) {}
+    Counted(const Counted& rhs) : v(rhs.v) { ++copies; }
+    Counted(Counted&& rhs) : v(rhs.v) { ++moves; }
+    Counted& operator=(const Counted& rhs) { v = rhs.v; ++copies; return *this; }
+    Counted& operator=(Counted&& rhs) { v = rhs.v; ++moves; return *this; }
+    bool operator==(const Counted& rhs) const { return v == rhs.v; }
+};
+
+template <typename Node>
+struct CountedNodes : HeapNodes<Node> {
+    static inline int allocations = 0;
+    Node* allocate() { ++allocations; return HeapNodes<Node>::allocate(); }
+};
+
+TEST_F(LinkedListTest, MoveSemantics) {
+    using Counting = List<Counted, CountedNodes<ListNode<Counted>>>;
+    std::vector<Counted> vec = {1, 2, 3};
+    Counted::copies = Counted::moves = 0;
+    Counting a(std::move(vec));
+    EXPECT_EQ(Counted::copies, 0);
+    EXPECT_EQ(Counted::moves, 3);
+
+    a.emplacer(4);
+    a.emplacel(0);
+    a.emplace(2, 9).v = 10;
+    a.pushr(Counted(5));
+    a.insert(1, Counted(6));
+    EXPECT_EQ(Counted::copies, 0);
+    EXPECT_EQ(Counted::moves, 5);
+
+    for (Counted& c : a) c.v *= 2; // iterators hand out references
+    EXPECT_EQ(a[3].v, 20);
+    EXPECT_EQ(a.begin()->v, 0);
+    EXPECT_TRUE(a == a);
+    EXPECT_EQ(a.find_vals(Counted(20)), std::vector<size_t>({3}));
+    a.del_vals(*a.back()); // val is an element of the list
+    EXPECT_EQ(a.size(), 7);
+    EXPECT_EQ(Counted::copies, 0);
+
+    int allocations = CountedNodes<ListNode<Counted>>::allocations;
+    Counting b(std::move(a));
+    EXPECT_TRUE(a.is_empty());
+    Counting c;
+    c = std::move(b);
+    EXPECT_TRUE(b.is_empty());
+    EXPECT_EQ(c.size(), 7);
+    EXPECT_EQ(Counted::copies, 0);
+    EXPECT_EQ(CountedNodes<ListNode<Counted>>::allocations, allocations); // nodes changed hands, none were made
+
+    b = c;
+    EXPECT_EQ(Counted::copies, 7);
+    EXPECT_TRUE(b == c);
+    b.pushr(a.emplacer(7)); // the moved-from list is still usable
+    EXPECT_EQ(b[-1].v, 7);
+}
+
+TEST_F(LinkedListTest, Parallel) {
+    parallel::ThreadPool pool(4);
+    List<int> big([](size_t n) -> int { return n % 7; }, 10000);
+    List<int> copy = big;
+    big.apply([](int n) { return n * n; }, pool);
+    copy.apply([](int n) { return n * n; });
+    EXPECT_TRUE(big == copy);
+    EXPECT_EQ(big.find_vals(36, pool), big.find_vals(36));
+    EXPECT_EQ(big.reduce(std::plus<>(), 5, pool), big.reduce(std::plus<>(), 5));
+
+    // Concatenation is associative but not commutative, so this checks the runs are folded in order.
+    List<std::string> words([](size_t n) { return std::string(1, 'a' + n % 26); }, 100);
+    auto concat = [](std::string a, const std::string& b) { return a + b; };
+    EXPECT_EQ(words.reduce(concat, ">", pool), words.reduce(concat, std::string(">")));
+    List<std::string> few = {"x", "y"};
+    EXPECT_EQ(few.reduce(concat, "", pool), "xy");
+    List<std::string> none;
+    EXPECT_EQ(none.reduce(concat, "z", pool), "z");
+    EXPECT_TRUE(none.find_vals("z", pool).empty());
+}
+
+TEST_F(LinkedListTest, SpliceAndSort) {
+    List<int> tail = ls.split_at(15);
+    EXPECT_EQ(tail.string(), "{16, 17, 18, 19, 20}");
+    EXPECT_EQ(ls.size(), 15);
+    List<int> rest = ls.split_at(-13); // everything from index 3 on moves out
+    EXPECT_EQ(ls.string(), "{1, 2, 3}");
+
+    {
+        List<int> other = {100, 101, 102};
+        ls.splice(ls.begin(), other, ++other.begin()); // 101
+        ls.splice(ls.end(), other); // 100, 102
+        EXPECT_TRUE(other.is_empty());
+        other.pushr(7); // other's pool now shares ls's slabs; both can keep allocating
+    } // other and its original pool are gone, but the nodes ls took from it stay valid
+    EXPECT_EQ(ls.string(), "{101, 1, 2, 3, 100, 102}");
+    ls.splice(++ls.begin(), rest, rest.begin(), rest.back()); // all of rest but its last element
+    EXPECT_EQ(ls.size(), 17);
+    EXPECT_EQ(rest.string(), "{15}");
+    ls.splice(ls.begin(), ls, ls.back()); // within one list
+    ls.concat(std::move(tail));
+    EXPECT_EQ(ls.string(), "{102, 101, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 1, 2, 3, 100, 16, 17, 18, 19, 20}");
+
+    ls.sort();
+    EXPECT_EQ(ls.string(), "{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 18, 19, 20, 100, 101, 102}");
+    EXPECT_EQ(*ls.back(), 102);
+    ls.merge(rest);
+    EXPECT_EQ(ls[14], 15);
+    EXPECT_EQ(ls.size(), 23);
+    ls.sort(std::greater<>());
+    EXPECT_EQ(ls[0], 102);
+    EXPECT_EQ(*--ls.back(), 2); // prev links are rebuilt
+
+    std::mt19937 rng(7);
+    std::vector<std::pair<int, int>> expected;
+    List<std::pair<int, int>> pairs;
+    for (int i = 0; i < 1000; ++i) {
+        expected.emplace_back(rng() % 50, i);
+        pairs.pushr(expected.back());
+    }
+    auto by_key = [](const auto& a, const auto& b) { return a.first < b.first; };
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    pairs.sort(by_key);
+    EXPECT_TRUE((pairs == List<std::pair<int, int>>(expected)));
+    List<std::pair<int, int>> equal_keys = {{0, -1}, {49, -1}};
+    pairs.merge(equal_keys, by_key);
+    int zeros = std::count_if(expected.begin(), expected.end(), [](const auto& p) { return p.first == 0; });
+    EXPECT_EQ(pairs[zeros], std::make_pair(0, -1)); // this list wins ties, so the new one goes after its 0s
+    EXPECT_EQ(pairs[-1], std::make_pair(49, -1));
+
+    // A long-lived queue taking a few entries at a time from short-lived lists keeps only the slabs it needs.
+    List<int> queue;
+    for (int round = 0; round < 1000; ++round) {
+        List<int> batch([](size_t n) -> int { return n; }, 100);
+        queue.splice(queue.end(), batch, batch.begin());
+        queue.splice(queue.end(), batch, batch.begin(), ++++batch.begin(), 2);
+        EXPECT_EQ(batch.size(), 97);
+        while (queue.size() > 30) queue.popl();
+    }
+    EXPECT_EQ(queue.string(), "{0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2}");
+    EXPECT_LE(queue.pool().slab_count(), 2);
+}
@@ -3,6 +3,7 @@
 #include "trie.hpp"
 #include "util.hpp"
 #include "rational.hpp"
+#include "heap.hpp"
 
 TEST(MiscellaneousTest, Trie) {
     Trie t;
@@ -41,4 +42,39 @@ TEST(MiscellaneousTest, Rational) {
     EXPECT_EQ(a + b, added);
     Rational divided(8, 35);
     EXPECT_EQ(a / b, divided);
+}
+
+template <typename Heap>
+std::vector<std::pair<uint32_t, double>> drain(Heap& heap) {
+    std::vector<std::pair<uint32_t, double>> ret;
+    while (!heap.empty()) ret.push_back(heap.pop());
+    return ret;
+}
+
+TEST(MiscellaneousTest, Heaps) {
+    std::vector<std::pair<uint32_t, double>> expected = {{3, 1}, {0, 2}, {4, 5}, {1, 7}, {2, 9}};
+    DaryHeap<4> dary(5);
+    PairingHeap pairing(5);
+    for (auto [id, key] : std::vector<std::pair<uint32_t, double>>{{0, 8}, {1, 7}, {2, 9}, {3, 4}, {4, 5}}) {
+        dary.push(id, key);
+        pairing.push(id, key);
+    }
+    dary.push(0, 2); pairing.push(0, 2); // decrease
+    dary.push(3, 1); pairing.push(3, 1);
+    dary.push(2, 10); pairing.push(2, 10); // larger keys are ignored
+    EXPECT_EQ(dary.top(), expected.front());
+    EXPECT_EQ(pairing.top(), expected.front());
+    EXPECT_EQ(drain(dary), expected);
+    EXPECT_EQ(drain(pairing), expected);
+    EXPECT_THROW(dary.pop();, EmptyHeap);
+
+    RadixHeap radix;
+    radix.push(0, 8); radix.push(1, 3); radix.push(2, 3); radix.push(3, 100);
+    EXPECT_EQ(radix.pop().second, 3);
+    EXPECT_EQ(radix.pop().second, 3);
+    radix.push(4, 6);
+    EXPECT_EQ(radix.pop(), std::make_pair(4u, 6.0));
+    EXPECT_THROW(radix.push(5, 2);, std::invalid_argument);
+    EXPECT_THROW(radix.push(5, 7.5);, std::invalid_argument);
+    EXPECT_EQ(drain(radix), (std::vector<std::pair<uint32_t, double>>{{0, 8}, {3, 100}}));
 }
\ No newline at end of file
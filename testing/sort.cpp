@@ -1,3 +1,10 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
 #include <gtest/gtest.h>
 
 #include "sort.hpp"
@@ -26,4 +33,130 @@ TEST_F(SortTest, Quick) {
 
 TEST_F(SortTest, Merge) {
     sort::merge(unsorted);
-}
\ No newline at end of file
+}
+
+// Raw values in the shapes that trip sorts up; each element type maps them onto its own values.
+std::vector<std::vector<uint64_t>> distributions(size_t n) {
+    std::mt19937_64 rng(12);
+    std::vector<uint64_t> random, ascending, descending, equal, few, sawtooth, organ_pipe;
+    for (size_t i = 0; i < n; ++i) {
+        random.push_back(rng());
+        ascending.push_back(i * 7);
+        descending.push_back((n - i) * 7);
+        equal.push_back(5);
+        few.push_back(rng() % 4);
+        sawtooth.push_back(i % 37);
+        organ_pipe.push_back(std::min(i, n - i));
+    }
+    return {{}, {42}, random, ascending, descending, equal, few, sawtooth, organ_pipe};
+}
+
+struct Record {
+    int key;
+    size_t order; // position in the input, to check stability
+    bool operator==(const Record&) const = default;
+};
+
+// Checks every sort against std::ranges::stable_sort. quick and radix_in_place are not stable, so only their keys
+// are compared.
+template <typename T, bool Radix, typename Make, typename Compare = std::ranges::less, typename Proj = std::identity>
+void check_sorts(Make make, Compare cmp = {}, Proj proj = {}) {
+    for (const auto& raw : distributions(1000)) {
+        std::vector<T> input;
+        for (size_t i = 0; i < raw.size(); ++i) input.push_back(make(raw[i], i));
+        auto expected = input;
+        std::ranges::stable_sort(expected, cmp, proj);
+        auto keys = [&](const std::vector<T>& v) {
+            std::vector<std::remove_cvref_t<std::invoke_result_t<Proj&, const T&>>> ret;
+            for (const T& x : v) ret.push_back(std::invoke(proj, x));
+            return ret;
+        };
+        auto quick = input;
+        sort::quick(quick, cmp, proj);
+        EXPECT_EQ(keys(quick), keys(expected));
+        auto merge = input;
+        sort::merge(merge.begin(), merge.end(), cmp, proj);
+        EXPECT_EQ(merge, expected);
+        auto insertion = input;
+        sort::insertion(insertion, cmp, proj);
+        EXPECT_EQ(insertion, expected);
+        if constexpr (Radix) {
+            auto radix = input;
+            sort::radix(radix, proj);
+            EXPECT_EQ(radix, expected);
+            auto in_place = input;
+            sort::radix_in_place(in_place, proj);
+            EXPECT_EQ(keys(in_place), keys(expected));
+        }
+    }
+}
+
+TEST(SortMatrix, Types) {
+    check_sorts<uint64_t, true>([](uint64_t x, size_t) { return x; });
+    check_sorts<uint32_t, true>([](uint64_t x, size_t) { return uint32_t(x); });
+    check_sorts<int, true>([](uint64_t x, size_t) { return int(x % 2001) - 1000; });
+    check_sorts<int64_t, true>([](uint64_t x, size_t) { return int64_t(x); });
+    check_sorts<int8_t, true>([](uint64_t x, size_t) { return int8_t(x); });
+    check_sorts<int, false>([](uint64_t x, size_t) { return int(x % 2001) - 1000; }, std::ranges::greater());
+    check_sorts<double, true>([](uint64_t x, size_t) { return double(x % 100000) / 7 - 5000; });
+    check_sorts<float, true>([](uint64_t x, size_t) { return float(int64_t(x)) * 1e-10f; });
+    check_sorts<std::string, false>([](uint64_t x, size_t) { return std::to_string(x % 5000); });
+    check_sorts<Record, true>([](uint64_t x, size_t i) { return Record{int(x % 50), i}; }, std::ranges::less(), &Record::key);
+}
+
+// Large enough to reach the ninther, block partitioning and the pattern-breaking paths of sort::quick.
+TEST(SortMatrix, QuickPatterns) {
+    std::mt19937_64 rng(7);
+    size_t n = 100000;
+    std::vector<std::vector<int>> inputs(8);
+    for (size_t i = 0; i < n; ++i) {
+        inputs[0].push_back(int(rng()));
+        inputs[1].push_back(int(i));
+        inputs[2].push_back(int(n - i));
+        inputs[3].push_back(int(i % 1000));
+        inputs[4].push_back(int(rng() % 8));
+        inputs[5].push_back(int(i % 2 ? i : n - i)); // interleaved ascending and descending
+        inputs[6].push_back(int(i + (i % 100 == 0 ? rng() % n : 0))); // sorted, a few out of place
+        inputs[7].push_back(int(std::min(i, n - i)));
+    }
+    for (auto& input : inputs) {
+        auto expected = input;
+        std::sort(expected.begin(), expected.end());
+        auto quick = input;
+        sort::quick(quick);
+        EXPECT_EQ(quick, expected);
+        // A string key takes the branching partition.
+        std::vector<std::string> strings;
+        for (int x : input) strings.push_back(std::to_string(x));
+        auto expected_strings = strings;
+        std::sort(expected_strings.begin(), expected_strings.end());
+        sort::quick(strings);
+        EXPECT_EQ(strings, expected_strings);
+    }
+}
+
+TEST(SortMatrix, RadixByKey) {
+    std::mt19937_64 rng(3);
+    std::vector<double> keys;
+    std::vector<std::string> values;
+    for (size_t i = 0; i < 10000; ++i) {
+        keys.push_back(double(int(rng() % 201) - 100) / 4);
+        values.push_back(std::to_string(i));
+    }
+    std::vector<std::pair<double, std::string>> expected;
+    for (size_t i = 0; i < keys.size(); ++i) expected.emplace_back(keys[i], values[i]);
+    std::ranges::stable_sort(expected, std::ranges::less(), &std::pair<double, std::string>::first);
+    sort::radix_by_key(keys, values);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(keys[i], expected[i].first);
+        EXPECT_EQ(values[i], expected[i].second);
+    }
+    values.pop_back();
+    EXPECT_THROW(sort::radix_by_key(keys, values), std::invalid_argument);
+
+    std::vector<double> special = {0.0, -std::numeric_limits<double>::infinity(), -1e-300, 1e300, -0.0, 2.5,
+                                   std::numeric_limits<double>::infinity(), -7.0};
+    sort::radix(special);
+    EXPECT_TRUE(std::ranges::is_sorted(special));
+    EXPECT_TRUE(std::signbit(special[3]) && !std::signbit(special[4])); // -0.0 before 0.0
+}